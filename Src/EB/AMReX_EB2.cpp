@@ -8,11 +8,19 @@
 #include <AMReX_EB2_IF_Torus.H>
 #include <AMReX_EB2_IF_Spline.H>
 #include <AMReX_EB2_IF_Parser.H>
+#include <AMReX_EB2_IF_STL.H>
 #include <AMReX_EB2_GeometryShop.H>
 #include <AMReX_EB2.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Utility.H>
 #include <AMReX.H>
 #include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
@@ -20,12 +28,14 @@ AMREX_EXPORT Vector<std::unique_ptr<IndexSpace> > IndexSpace::m_instance;
 
 AMREX_EXPORT int max_grid_size = 64;
 AMREX_EXPORT bool extend_domain_face = true;
+AMREX_EXPORT bool compact_cut_cell_data = false;
 
 void Initialize ()
 {
     ParmParse pp("eb2");
     pp.query("max_grid_size", max_grid_size);
     pp.query("extend_domain_face", extend_domain_face);
+    pp.query("compact_cut_cell_data", compact_cut_cell_data);
 
     amrex::ExecOnFinalize(Finalize);
 }
@@ -40,6 +50,16 @@ bool ExtendDomainFace ()
     return extend_domain_face;
 }
 
+bool CompactCutCellData ()
+{
+    return compact_cut_cell_data;
+}
+
+void SetCompactCutCellData (bool compact)
+{
+    compact_cut_cell_data = compact;
+}
+
 void
 IndexSpace::push (IndexSpace* ispace)
 {
@@ -71,9 +91,189 @@ const IndexSpace* TopIndexSpaceIfPresent() noexcept {
     return nullptr;
 }
 
+namespace {
+    const std::string indexspace_header_version("EB2::IndexSpace-V1");
+}
+
 void
-Build (const Geometry& geom, int required_coarsening_level,
-       int max_coarsening_level, int ngrow, bool build_coarse_level_by_coarsening)
+IndexSpace::writeLevels (const std::string& dirname, const std::string& key,
+                         Vector<Level const*> const& levels, Vector<int> const& ngrow)
+{
+    BL_PROFILE("EB2::IndexSpace::writeLevels()");
+
+    const int nlevels = levels.size();
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dirname, 0755)) {
+            amrex::CreateDirectoryFailed(dirname);
+        }
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            const std::string& levdir = amrex::LevelFullPath(ilev, dirname);
+            if (!amrex::UtilCreateDirectory(levdir, 0755)) {
+                amrex::CreateDirectoryFailed(levdir);
+            }
+        }
+    }
+    ParallelDescriptor::Barrier();
+
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        levels[ilev]->write(amrex::LevelFullPath(ilev, dirname));
+    }
+
+    // The header is written last so that an incomplete directory is not read.
+    ParallelDescriptor::Barrier();
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::string hname = dirname + "/Header";
+        std::ofstream ofs(hname.c_str());
+        if (!ofs.good()) {
+            amrex::FileOpenFailed(hname);
+        }
+        ofs << indexspace_header_version << "\n"
+            << (key.empty() ? std::string("-") : key) << "\n"
+            << nlevels << "\n";
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            ofs << levels[ilev]->Geom().Domain() << " " << ngrow[ilev] << "\n";
+        }
+        if (!ofs.good()) {
+            amrex::Abort("EB2::IndexSpace::writeLevels: failed to write " + hname);
+        }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+IndexSpaceChkptFile::IndexSpaceChkptFile (const std::string& dirname, const Geometry& geom,
+                                          int required_coarsening_level,
+                                          int max_coarsening_level,
+                                          const std::string& key)
+{
+    BL_PROFILE("EB2::IndexSpaceChkptFile()");
+
+    AMREX_ALWAYS_ASSERT(required_coarsening_level >= 0 && required_coarsening_level <= 30);
+    max_coarsening_level = std::max(required_coarsening_level,max_coarsening_level);
+    max_coarsening_level = std::min(30,max_coarsening_level);
+
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(dirname + "/Header", fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream is(fileCharPtrString, std::istringstream::in);
+
+    std::string version, file_key;
+    int nlevels;
+    is >> version >> file_key >> nlevels;
+    if (version != indexspace_header_version) {
+        amrex::Abort("EB2::IndexSpaceChkptFile: unknown version " + version + " in " + dirname);
+    }
+    if (!key.empty() && key != file_key) {
+        amrex::Abort("EB2::IndexSpaceChkptFile: the key in " + dirname + " does not match");
+    }
+    if (nlevels <= required_coarsening_level) {
+        amrex::Abort("EB2::IndexSpaceChkptFile: " + dirname + " does not have the required coarse levels");
+    }
+    nlevels = std::min(nlevels, max_coarsening_level+1);
+
+    m_chkpt_level.reserve(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        Box domain;
+        int ng;
+        is >> domain >> ng;
+        if (!is.good()) {
+            amrex::Abort("EB2::IndexSpaceChkptFile: failed to read " + dirname + "/Header");
+        }
+
+        Geometry const& lgeom = (ilev == 0) ? geom : amrex::coarsen(m_geom.back(),2);
+        if (domain != lgeom.Domain()) {
+            amrex::Abort("EB2::IndexSpaceChkptFile: the domain of level " + std::to_string(ilev)
+                         + " in " + dirname + " does not match");
+        }
+
+        m_chkpt_level.emplace_back(this, lgeom, amrex::LevelFullPath(ilev, dirname));
+        m_geom.push_back(lgeom);
+        m_domain.push_back(domain);
+        m_ngrow.push_back(ng);
+    }
+}
+
+const Level&
+IndexSpaceChkptFile::getLevel (const Geometry& geom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), geom.Domain());
+    int i = std::distance(m_domain.begin(), it);
+    return m_chkpt_level[i];
+}
+
+const Geometry&
+IndexSpaceChkptFile::getGeometry (const Box& dom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), dom);
+    int i = std::distance(m_domain.begin(), it);
+    return m_geom[i];
+}
+
+void
+IndexSpaceChkptFile::writeChkptFile (const std::string& dirname, const std::string& key) const
+{
+    Vector<Level const*> levels;
+    for (auto const& lev : m_chkpt_level) {
+        levels.push_back(&lev);
+    }
+    writeLevels(dirname, key, levels, m_ngrow);
+}
+
+void
+BuildFromChkptFile (const std::string& dirname, const Geometry& geom,
+                    int required_coarsening_level, int max_coarsening_level,
+                    const std::string& key)
+{
+    BL_PROFILE("EB2::BuildFromChkptFile()");
+    IndexSpace::push(new IndexSpaceChkptFile(dirname, geom,
+                                             required_coarsening_level,
+                                             max_coarsening_level, key));
+}
+
+std::string
+chkptKey (const Geometry& geom, int required_coarsening_level,
+          int max_coarsening_level, int ngrow, bool build_coarse_level_by_coarsening)
+{
+    std::ostringstream os;
+    os << std::setprecision(17)
+       << AMREX_SPACEDIM << " " << sizeof(Real) << " "
+       << geom.Domain() << " " << geom.Coord() << " "
+       << geom.ProbDomain() << " ";
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        os << geom.isPeriodic(idim) << " ";
+    }
+    os << required_coarsening_level << " " << max_coarsening_level << " "
+       << ngrow << " " << build_coarse_level_by_coarsening << " "
+       << EB2::max_grid_size << " " << EB2::extend_domain_face << "\n";
+
+    ParmParse pp;
+    for (auto const& name : ParmParse::getEntries("eb2")) {
+        if (name == "eb2.chkpt_dir") continue;
+        std::vector<std::string> vals;
+        pp.queryarr(name.c_str(), vals);
+        os << name;
+        for (auto const& v : vals) {
+            os << " " << v;
+        }
+        os << "\n";
+    }
+
+    // 64-bit FNV-1a
+    std::uint64_t h = 14695981039346656037ULL;
+    for (char c : os.str()) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    std::ostringstream hs;
+    hs << std::hex << std::setw(16) << std::setfill('0') << h;
+    return hs.str();
+}
+
+namespace {
+void
+BuildFromParmParse (const Geometry& geom, int required_coarsening_level,
+                    int max_coarsening_level, int ngrow, bool build_coarse_level_by_coarsening)
 {
     ParmParse pp("eb2");
     std::string geom_type;
@@ -189,11 +389,81 @@ Build (const Geometry& geom, int required_coarsening_level,
         EB2::Build(gshop, geom, required_coarsening_level,
                    max_coarsening_level, ngrow, build_coarse_level_by_coarsening);
     }
+#if (AMREX_SPACEDIM == 3)
+    else if (geom_type == "stl")
+    {
+        std::string stl_file;
+        pp.get("stl_file", stl_file);
+
+        bool has_fluid_inside = false;
+        pp.query("stl_has_fluid_inside", has_fluid_inside);
+
+        bool use_winding_number = false;
+        pp.query("stl_use_winding_number", use_winding_number);
+
+        // Only the surface and the sign of the distance matter here.
+        Real max_distance = 4.0*geom.CellSize(0);
+        for (int idim = 1; idim < AMREX_SPACEDIM; ++idim) {
+            max_distance = std::max(max_distance, 4.0*geom.CellSize(idim));
+        }
+        pp.query("stl_max_distance", max_distance);
+
+        auto stl = std::make_shared<STLtools>();
+        stl->setUseWindingNumber(use_winding_number);
+        stl->read_stl_file(stl_file);
+
+        EB2::STLIF sif(*stl, has_fluid_inside, max_distance);
+        EB2::GeometryShop<EB2::STLIF,std::shared_ptr<STLtools> > gshop(sif,stl);
+        EB2::Build(gshop, geom, required_coarsening_level,
+                   max_coarsening_level, ngrow, build_coarse_level_by_coarsening);
+    }
+#endif
     else
     {
         amrex::Abort("geom_type "+geom_type+ " not supported");
     }
 }
+}
+
+void
+Build (const Geometry& geom, int required_coarsening_level,
+       int max_coarsening_level, int ngrow, bool build_coarse_level_by_coarsening)
+{
+    ParmParse pp("eb2");
+    std::string chkpt_dir;
+    if (!pp.query("chkpt_dir", chkpt_dir)) {
+        BuildFromParmParse(geom, required_coarsening_level, max_coarsening_level,
+                           ngrow, build_coarse_level_by_coarsening);
+        return;
+    }
+
+    // The geometry is read from chkpt_dir if it has been written with the
+    // same parameters, and is otherwise built and written there.
+    const std::string key = chkptKey(geom, required_coarsening_level, max_coarsening_level,
+                                     ngrow, build_coarse_level_by_coarsening);
+    const std::string dirname = chkpt_dir + "/eb2_" + key;
+    int exists = 0;
+    if (ParallelDescriptor::IOProcessor()) {
+        exists = amrex::FileExists(dirname + "/Header");
+    }
+    ParallelDescriptor::Bcast(&exists, 1, ParallelDescriptor::IOProcessorNumber());
+
+    if (exists) {
+        amrex::Print() << "EB2::Build: reading " << dirname << "\n";
+        BuildFromChkptFile(dirname, geom, required_coarsening_level, max_coarsening_level, key);
+    } else {
+        BuildFromParmParse(geom, required_coarsening_level, max_coarsening_level,
+                           ngrow, build_coarse_level_by_coarsening);
+        if (ParallelDescriptor::IOProcessor()) {
+            if (!amrex::UtilCreateDirectory(chkpt_dir, 0755)) {
+                amrex::CreateDirectoryFailed(chkpt_dir);
+            }
+        }
+        ParallelDescriptor::Barrier();
+        amrex::Print() << "EB2::Build: writing " << dirname << "\n";
+        IndexSpace::top().writeChkptFile(dirname, key);
+    }
+}
 
 namespace {
 static int comp_max_crse_level (Box cdomain, const Box& domain)
@@ -1,7 +1,10 @@
 
 #include <AMReX_EB2_Level.H>
+#include <AMReX_EBDataCollection.H>
 #include <AMReX_IArrayBox.H>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
@@ -79,6 +82,49 @@ Level::prepareForCoarsening (const Level& rhs, int max_grid_size, IntVect ngrow)
     m_ok = true;
 }
 
+void
+Level::addEBDataCollection (std::shared_ptr<EBDataCollection> const& ebdc) const
+{
+    m_ebdc.erase(std::remove_if(m_ebdc.begin(), m_ebdc.end(),
+                                [] (std::weak_ptr<EBDataCollection> const& p)
+                                { return p.expired(); }),
+                 m_ebdc.end());
+    m_ebdc.push_back(ebdc);
+}
+
+void
+Level::update (Level&& rhs)
+{
+    AMREX_ALWAYS_ASSERT(m_geom.Domain() == rhs.m_geom.Domain());
+
+    m_ngrow = rhs.m_ngrow;
+    m_grids = std::move(rhs.m_grids);
+    m_covered_grids = std::move(rhs.m_covered_grids);
+    m_dmap = std::move(rhs.m_dmap);
+    // m_levelset may be an alias of m_mgf.
+    m_levelset = std::move(rhs.m_levelset);
+    m_mgf = std::move(rhs.m_mgf);
+    m_cellflag = std::move(rhs.m_cellflag);
+    m_volfrac = std::move(rhs.m_volfrac);
+    m_centroid = std::move(rhs.m_centroid);
+    m_bndryarea = std::move(rhs.m_bndryarea);
+    m_bndrycent = std::move(rhs.m_bndrycent);
+    m_bndrynorm = std::move(rhs.m_bndrynorm);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_areafrac[idim] = std::move(rhs.m_areafrac[idim]);
+        m_facecent[idim] = std::move(rhs.m_facecent[idim]);
+        m_edgecent[idim] = std::move(rhs.m_edgecent[idim]);
+    }
+    m_allregular = rhs.m_allregular;
+    m_ok = rhs.m_ok;
+
+    for (auto const& p : m_ebdc) {
+        if (auto ebdc = p.lock()) {
+            ebdc->update(*this);
+        }
+    }
+}
+
 int
 Level::coarsenFromFine (Level& fineLevel, bool fill_boundary)
 {
@@ -467,7 +513,7 @@ Level::fillEBCellFlag (FabArray<EBCellFlagFab>& cellflag, const Geometry& geom)
             }
 
             // fix type for each fab
-            fab.setType(FabType::undefined);
+            fab.resetType();
             auto typ = fab.getType(bx);
             fab.setType(typ);
             for (int nshrink = 1; nshrink < ng; ++nshrink) {
@@ -916,4 +962,173 @@ Level::fillLevelSet (MultiFab& levelset, const Geometry& geom) const
     }
 }
 
+namespace {
+    const std::string level_header_version("EB2::Level-V1");
+
+    // The flags are stored as two 16-bit halves, which are exact even with
+    // single-precision Real.
+    void flag_to_real (MultiFab& mf, FabArray<EBCellFlagFab> const& cellflag)
+    {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.fabbox();
+            auto const& a = mf.array(mfi);
+            auto const& f = cellflag.const_array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+            {
+                const uint32_t v = f(i,j,k).getValue();
+                a(i,j,k,0) = static_cast<Real>(v & 0xffffu);
+                a(i,j,k,1) = static_cast<Real>(v >> 16);
+            });
+        }
+    }
+
+    void real_to_flag (FabArray<EBCellFlagFab>& cellflag, MultiFab const& mf)
+    {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.fabbox();
+            auto const& a = mf.const_array(mfi);
+            auto const& f = cellflag.array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+            {
+                const auto lo = static_cast<uint32_t>(a(i,j,k,0));
+                const auto hi = static_cast<uint32_t>(a(i,j,k,1));
+                f(i,j,k) = EBCellFlag(lo | (hi << 16));
+            });
+        }
+    }
+
+    std::string face_name (const std::string& name, int idim)
+    {
+        return name + "_" + std::to_string(idim);
+    }
+}
+
+void
+Level::write (const std::string& dirname) const
+{
+    BL_PROFILE("EB2::Level::write()");
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::string hname = dirname + "/Header";
+        std::ofstream ofs(hname.c_str());
+        if (!ofs.good()) {
+            amrex::FileOpenFailed(hname);
+        }
+        ofs << level_header_version << "\n"
+            << m_geom.Domain() << "\n"
+            << static_cast<int>(m_allregular) << "\n"
+            << m_ngrow << "\n"
+            << static_cast<int>(!m_covered_grids.empty()) << "\n";
+        if (!m_allregular) {
+            m_grids.writeOn(ofs);
+            ofs << "\n";
+        }
+        if (!m_covered_grids.empty()) {
+            m_covered_grids.writeOn(ofs);
+            ofs << "\n";
+        }
+        if (!ofs.good()) {
+            amrex::Abort("EB2::Level::write: failed to write " + hname);
+        }
+    }
+
+    if (m_allregular) return;
+
+    {
+        MultiFab flag(m_grids, m_dmap, 2, m_cellflag.nGrow());
+        flag_to_real(flag, m_cellflag);
+        VisMF::Write(flag, dirname + "/CellFlag");
+    }
+    VisMF::Write(m_volfrac, dirname + "/VolFrac");
+    VisMF::Write(m_centroid, dirname + "/Centroid");
+    VisMF::Write(m_bndryarea, dirname + "/BndryArea");
+    VisMF::Write(m_bndrycent, dirname + "/BndryCent");
+    VisMF::Write(m_bndrynorm, dirname + "/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        VisMF::Write(m_areafrac[idim], face_name(dirname + "/AreaFrac", idim));
+        VisMF::Write(m_facecent[idim], face_name(dirname + "/FaceCent", idim));
+        VisMF::Write(m_edgecent[idim], face_name(dirname + "/EdgeCent", idim));
+    }
+    VisMF::Write(m_levelset, dirname + "/LevelSet");
+}
+
+ChkptFileLevel::ChkptFileLevel (IndexSpace const* is, const Geometry& geom,
+                                const std::string& dirname)
+    : Level(is, geom)
+{
+    BL_PROFILE("EB2::ChkptFileLevel()");
+
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(dirname + "/Header", fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream hs(fileCharPtrString, std::istringstream::in);
+
+    std::string version;
+    Box domain;
+    int allregular, has_covered;
+    hs >> version >> domain >> allregular >> m_ngrow >> has_covered;
+    if (version != level_header_version) {
+        amrex::Abort("EB2::ChkptFileLevel: unknown version " + version + " in " + dirname);
+    }
+    if (domain != geom.Domain()) {
+        amrex::Abort("EB2::ChkptFileLevel: the domain in " + dirname + " does not match");
+    }
+    m_allregular = allregular;
+    if (!m_allregular) {
+        m_grids.readFrom(hs);
+    }
+    if (has_covered) {
+        m_covered_grids.readFrom(hs);
+    }
+    if (!hs.good()) {
+        amrex::Abort("EB2::ChkptFileLevel: failed to read " + dirname + "/Header");
+    }
+
+    m_ok = true;
+    if (m_allregular) return;
+
+    // The other MultiFabs are read with the layout of the flags.
+    MultiFab flag;
+    VisMF::Read(flag, dirname + "/CellFlag");
+    AMREX_ALWAYS_ASSERT(flag.boxArray() == m_grids);
+    m_dmap = flag.DistributionMap();
+    const int ng = flag.nGrow();
+    MFInfo mf_info;
+    mf_info.SetTag("EB2::Level");
+    m_cellflag.define(m_grids, m_dmap, 1, ng, mf_info);
+    real_to_flag(m_cellflag, flag);
+
+    auto read = [&] (MultiFab& mf, const BoxArray& ba, int ncomp, const std::string& name)
+    {
+        mf.define(ba, m_dmap, ncomp, ng, mf_info);
+        VisMF::Read(mf, dirname + "/" + name);
+    };
+
+    read(m_volfrac, m_grids, 1, "VolFrac");
+    read(m_centroid, m_grids, AMREX_SPACEDIM, "Centroid");
+    read(m_bndryarea, m_grids, 1, "BndryArea");
+    read(m_bndrycent, m_grids, AMREX_SPACEDIM, "BndryCent");
+    read(m_bndrynorm, m_grids, AMREX_SPACEDIM, "BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        read(m_areafrac[idim], amrex::convert(m_grids, IntVect::TheDimensionVector(idim)),
+             1, face_name("AreaFrac", idim));
+        read(m_facecent[idim], amrex::convert(m_grids, IntVect::TheDimensionVector(idim)),
+             AMREX_SPACEDIM-1, face_name("FaceCent", idim));
+        IntVect edge_type{1}; edge_type[idim] = 0;
+        read(m_edgecent[idim], amrex::convert(m_grids, edge_type), 1, face_name("EdgeCent", idim));
+    }
+
+    // The level set may have a different number of ghost nodes.
+    VisMF::Read(m_levelset, dirname + "/LevelSet");
+}
+
 }}
@@ -0,0 +1,146 @@
+
+#include <AMReX_EBCutCellData.H>
+#include <AMReX_EB2_Level.H>
+#include <AMReX_MultiCutFab.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Scan.H>
+
+#include <limits>
+
+namespace amrex {
+
+EBCutCellData::EBCutCellData (const EB2::Level& a_level, const Geometry& a_geom,
+                              const BoxArray& a_ba, const DistributionMapping& a_dm,
+                              int a_ngrow)
+    : m_ngrow(a_ngrow),
+      m_stride(offset(NumQuantities)),
+      m_index(a_ba, a_dm),
+      m_data(a_ba, a_dm)
+{
+    BL_PROFILE("EBCutCellData::EBCutCellData()");
+
+    FabArray<EBCellFlagFab> cellflags(a_ba, a_dm, 1, m_ngrow, MFInfo(),
+                                      DefaultFabFactory<EBCellFlagFab>());
+    a_level.fillEBCellFlag(cellflags, a_geom);
+
+    // Number the cut cells of each box.
+    for (MFIter mfi(cellflags); mfi.isValid(); ++mfi)
+    {
+        if (cellflags[mfi].getType() != FabType::singlevalued) continue;
+
+        const Box& bx = mfi.fabbox();
+        auto& index = m_index[mfi];
+        index.resize(bx, 1);
+        auto const& idx = index.array();
+        auto const& flag = cellflags.const_array(mfi);
+        AMREX_ASSERT(bx.numPts() < static_cast<Long>(std::numeric_limits<int>::max()));
+        const int npts = bx.numPts();
+        const int ncut = Scan::PrefixSum<int>(npts,
+            [=] AMREX_GPU_DEVICE (int ioff) noexcept -> int
+            {
+                const Dim3 cell = bx.atOffset(ioff).dim3();
+                return flag(cell.x,cell.y,cell.z).isSingleValued() ? 1 : 0;
+            },
+            [=] AMREX_GPU_DEVICE (int ioff, int ps) noexcept
+            {
+                const Dim3 cell = bx.atOffset(ioff).dim3();
+                idx(cell.x,cell.y,cell.z) = flag(cell.x,cell.y,cell.z).isSingleValued() ? ps : -1;
+            },
+            Scan::Type::exclusive);
+        m_data[mfi].resize(static_cast<std::size_t>(ncut)*m_stride);
+    }
+
+    // The quantities are filled one at a time to limit the temporary memory.
+    MultiFab tmp(a_ba, a_dm, AMREX_SPACEDIM, m_ngrow, MFInfo(), FArrayBoxFactory());
+    for (int iq = 0; iq < NumQuantities; ++iq)
+    {
+        const auto q = static_cast<Quantity>(iq);
+        const int nc = nComp(q);
+        MultiFab mf(tmp, amrex::make_alias, 0, nc);
+        switch (q) {
+        case Centroid:    a_level.fillCentroid(mf, a_geom);  break;
+        case BndryCent:   a_level.fillBndryCent(mf, a_geom); break;
+        case BndryArea:   a_level.fillBndryArea(mf, a_geom); break;
+        case BndryNormal: a_level.fillBndryNorm(mf, a_geom); break;
+        default: break;
+        }
+
+        const int off = offset(q);
+        const int stride = m_stride;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            if (!ok(mfi) || numCutCells(mfi) == 0) continue;
+            auto const& idx = m_index[mfi].const_array();
+            auto const& a = mf.const_array(mfi);
+            Real* p = m_data[mfi].data();
+            amrex::ParallelFor(mfi.fabbox(), nc,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                const int m = idx(i,j,k);
+                if (m >= 0) {
+                    p[m*stride+off+n] = a(i,j,k,n);
+                }
+            });
+        }
+    }
+}
+
+CutCellConstArray4
+EBCutCellData::const_array (const MFIter& mfi, Quantity q) const noexcept
+{
+    AMREX_ASSERT(ok(mfi));
+    CutCellConstArray4 r;
+    r.index = m_index[mfi].const_array();
+    r.p = (m_data[mfi].empty()) ? nullptr : m_data[mfi].data() + offset(q);
+    r.stride = m_stride;
+    r.default_value = defaultValue(q);
+    return r;
+}
+
+void
+EBCutCellData::copyTo (MultiCutFab& mcf, Quantity q) const
+{
+    BL_PROFILE("EBCutCellData::copyTo()");
+
+    AMREX_ALWAYS_ASSERT(mcf.nGrow() <= m_ngrow && mcf.nComp() == nComp(q));
+
+    const int nc = nComp(q);
+    const Real dflt = defaultValue(q);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(mcf.data()); mfi.isValid(); ++mfi)
+    {
+        if (!mcf.ok(mfi)) continue;
+        auto const& a = mcf.array(mfi);
+        if (ok(mfi)) {
+            auto const& c = const_array(mfi, q);
+            amrex::ParallelFor(mfi.fabbox(), nc,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = c(i,j,k,n);
+            });
+        } else {
+            amrex::ParallelFor(mfi.fabbox(), nc,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = dflt;
+            });
+        }
+    }
+}
+
+Long
+EBCutCellData::nBytes () const
+{
+    Long r = 0;
+    for (MFIter mfi(m_index); mfi.isValid(); ++mfi) {
+        r += m_index[mfi].nBytes() + m_data[mfi].size()*sizeof(Real);
+    }
+    return r;
+}
+
+}
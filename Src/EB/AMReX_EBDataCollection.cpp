@@ -3,7 +3,12 @@
 #include <AMReX_MultiFab.H>
 #include <AMReX_MultiCutFab.H>
 
+#include <AMReX_EB2.H>
 #include <AMReX_EB2_Level.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
 
 namespace amrex {
 
@@ -33,7 +38,46 @@ EBDataCollection::EBDataCollection (const EB2::Level& a_level,
     {
         m_volfrac = new MultiFab(a_ba, a_dm, 1, m_ngrow[1], MFInfo(), FArrayBoxFactory());
         a_level.fillVolFrac(*m_volfrac, m_geom);
+    }
+
+    defineCutData(a_level);
+}
+
+void
+EBDataCollection::update (const EB2::Level& a_level)
+{
+    BL_PROFILE("EBDataCollection::update()");
+
+    if (m_support >= EBSupport::basic)
+    {
+        m_cellflags->setVal(EBCellFlag::TheDefaultCell());
+        a_level.fillEBCellFlag(*m_cellflags, m_geom);
+        a_level.fillLevelSet(*m_levelset, m_geom);
+    }
+
+    if (m_support >= EBSupport::volume)
+    {
+        a_level.fillVolFrac(*m_volfrac, m_geom);
+    }
+
+    // The MultiCutFabs have data only in the boxes with cut cells, which
+    // may have changed.
+    clearCutData();
+    defineCutData(a_level);
+}
+
+void
+EBDataCollection::defineCutData (const EB2::Level& a_level)
+{
+    if (m_support < EBSupport::volume) return;
+
+    const BoxArray& a_ba = m_cellflags->boxArray();
+    const DistributionMapping& a_dm = m_cellflags->DistributionMap();
 
+    const bool compact = (m_support == EBSupport::full) && EB2::CompactCutCellData();
+
+    if (!compact)
+    {
         m_centroid = new MultiCutFab(a_ba, a_dm, AMREX_SPACEDIM, m_ngrow[1], *m_cellflags);
         a_level.fillCentroid(*m_centroid, m_geom);
     }
@@ -42,14 +86,19 @@ EBDataCollection::EBDataCollection (const EB2::Level& a_level,
     {
         const int ng = m_ngrow[2];
 
-        m_bndrycent = new MultiCutFab(a_ba, a_dm, AMREX_SPACEDIM, ng, *m_cellflags);
-        a_level.fillBndryCent(*m_bndrycent, m_geom);
+        if (compact) {
+            m_cutcells = new EBCutCellData(a_level, m_geom, a_ba, a_dm,
+                                           std::max(m_ngrow[1], ng));
+        } else {
+            m_bndrycent = new MultiCutFab(a_ba, a_dm, AMREX_SPACEDIM, ng, *m_cellflags);
+            a_level.fillBndryCent(*m_bndrycent, m_geom);
 
-        m_bndryarea = new MultiCutFab(a_ba, a_dm, 1, ng, *m_cellflags);
-        a_level.fillBndryArea(*m_bndryarea, m_geom);
+            m_bndryarea = new MultiCutFab(a_ba, a_dm, 1, ng, *m_cellflags);
+            a_level.fillBndryArea(*m_bndryarea, m_geom);
 
-        m_bndrynorm = new MultiCutFab(a_ba, a_dm, AMREX_SPACEDIM, ng, *m_cellflags);
-        a_level.fillBndryNorm(*m_bndrynorm, m_geom);
+            m_bndrynorm = new MultiCutFab(a_ba, a_dm, AMREX_SPACEDIM, ng, *m_cellflags);
+            a_level.fillBndryNorm(*m_bndrynorm, m_geom);
+        }
 
         for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
             const BoxArray& faceba = amrex::convert(a_ba, IntVect::TheDimensionVector(idim));
@@ -66,22 +115,37 @@ EBDataCollection::EBDataCollection (const EB2::Level& a_level,
     }
 }
 
-EBDataCollection::~EBDataCollection ()
+void
+EBDataCollection::clearCutData ()
 {
-    delete m_cellflags;
-    delete m_levelset;
-    delete m_volfrac;
     delete m_centroid;
     delete m_bndrycent;
     delete m_bndrynorm;
     delete m_bndryarea;
+    delete m_cutcells;
+    m_centroid = nullptr;
+    m_bndrycent = nullptr;
+    m_bndrynorm = nullptr;
+    m_bndryarea = nullptr;
+    m_cutcells = nullptr;
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
         delete m_areafrac[idim];
         delete m_facecent[idim];
         delete m_edgecent[idim];
+        m_areafrac[idim] = nullptr;
+        m_facecent[idim] = nullptr;
+        m_edgecent[idim] = nullptr;
     }
 }
 
+EBDataCollection::~EBDataCollection ()
+{
+    delete m_cellflags;
+    delete m_levelset;
+    delete m_volfrac;
+    clearCutData();
+}
+
 const FabArray<EBCellFlagFab>&
 EBDataCollection::getMultiEBCellFlagFab () const
 {
@@ -106,6 +170,9 @@ EBDataCollection::getVolFrac () const
 const MultiCutFab&
 EBDataCollection::getCentroid () const
 {
+    if (m_cutcells != nullptr) {
+        makeMultiCutFab(m_centroid, EBCutCellData::Centroid, m_ngrow[1]);
+    }
     AMREX_ASSERT(m_centroid != nullptr);
     return *m_centroid;
 }
@@ -113,6 +180,9 @@ EBDataCollection::getCentroid () const
 const MultiCutFab&
 EBDataCollection::getBndryCent () const
 {
+    if (m_cutcells != nullptr) {
+        makeMultiCutFab(m_bndrycent, EBCutCellData::BndryCent, m_ngrow[2]);
+    }
     AMREX_ASSERT(m_bndrycent != nullptr);
     return *m_bndrycent;
 }
@@ -120,6 +190,9 @@ EBDataCollection::getBndryCent () const
 const MultiCutFab&
 EBDataCollection::getBndryArea () const
 {
+    if (m_cutcells != nullptr) {
+        makeMultiCutFab(m_bndryarea, EBCutCellData::BndryArea, m_ngrow[2]);
+    }
     AMREX_ASSERT(m_bndryarea != nullptr);
     return *m_bndryarea;
 }
@@ -148,8 +221,33 @@ EBDataCollection::getEdgeCent () const
 const MultiCutFab&
 EBDataCollection::getBndryNormal () const
 {
+    if (m_cutcells != nullptr) {
+        makeMultiCutFab(m_bndrynorm, EBCutCellData::BndryNormal, m_ngrow[2]);
+    }
     AMREX_ASSERT(m_bndrynorm != nullptr);
     return *m_bndrynorm;
 }
 
+void
+EBDataCollection::makeMultiCutFab (MultiCutFab*& mcf, EBCutCellData::Quantity q, int ngrow) const
+{
+    // Other threads may ask for the same data.  The MFIter loops of the
+    // copy cannot run in a parallel region.
+    std::lock_guard<std::mutex> lock(m_dense_mutex);
+    if (mcf != nullptr) { return; }
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!OpenMP::in_parallel(),
+                                     "EBDataCollection: cannot make dense cut cell data in a parallel region");
+
+    static const char* names[] = {"centroid", "boundary centroid", "boundary area",
+                                  "boundary normal"};
+    if (amrex::Verbose()) {
+        amrex::Print() << "EBDataCollection: making dense " << names[q]
+                       << " from the compact cut cell data\n";
+    }
+    auto r = new MultiCutFab(m_cellflags->boxArray(), m_cellflags->DistributionMap(),
+                             EBCutCellData::nComp(q), ngrow, *m_cellflags);
+    m_cutcells->copyTo(*r, q);
+    mcf = r;
+}
+
 }
@@ -20,7 +20,9 @@ EBFArrayBoxFactory::EBFArrayBoxFactory (const EB2::Level& a_level,
       m_geom(a_geom),
       m_ebdc(std::make_shared<EBDataCollection>(a_level,a_geom,a_ba,a_dm,a_ngrow,a_support)),
       m_parent(&a_level)
-{}
+{
+    a_level.addEBDataCollection(m_ebdc);
+}
 
 AMREX_NODISCARD
 FArrayBox*
@@ -57,7 +57,8 @@ EBMFCellConsLinInterp::interp (MultiFab const& crsemf, int ccomp, MultiFab& fine
             Box const target_fine_region = amrex::grow(mfi.validbox(),ng) & dest_domain;
             Box const& crse_bx = CoarseBox(target_fine_region, ratio);
             const EBCellFlagFab& crse_flag_fab = cflags[mfi];
-            if (crsemf[mfi].getType() != FabType::regular) {
+            // Not crsemf[mfi].getType(), which is not changed by EB2::Update.
+            if (crse_flag_fab.getType(amrex::enclosedCells(crsemf[mfi].box())) != FabType::regular) {
                 const EBCellFlagFab& fine_flag_fab = fflags[mfi];
                 const FabType ftype = fine_flag_fab.getType(target_fine_region);
                 const FabType ctype = crse_flag_fab.getType(crse_bx);
@@ -0,0 +1,357 @@
+
+#include <AMReX_EBSignedDistance.H>
+#include <AMReX_EB2_Level.H>
+#include <AMReX_EBCellFlag.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_ParallelReduce.H>
+
+#include <cmath>
+#include <limits>
+
+namespace amrex {
+
+namespace {
+
+    // Upwind update of |grad u| = 1 at a node that is not next to the EB.
+    // The smallest neighbors in each direction are sorted, and the largest
+    // number of them that are smaller than the solution are used.
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void sd_relax (int i, int j, int k, Array4<Real> const& u,
+                   Array4<Real const> const& src, Real far,
+                   GpuArray<Real,AMREX_SPACEDIM> const& dx) noexcept
+    {
+        if (amrex::Math::abs(src(i,j,k)) != far) return;
+
+        Real a[AMREX_SPACEDIM];
+        Real h[AMREX_SPACEDIM];
+        AMREX_D_TERM(a[0] = amrex::min(u(i-1,j,k),u(i+1,j,k));,
+                     a[1] = amrex::min(u(i,j-1,k),u(i,j+1,k));,
+                     a[2] = amrex::min(u(i,j,k-1),u(i,j,k+1)););
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            h[d] = dx[d];
+        }
+        for (int d = 1; d < AMREX_SPACEDIM; ++d) {
+            for (int m = d; m > 0 && a[m] < a[m-1]; --m) {
+                amrex::Swap(a[m], a[m-1]);
+                amrex::Swap(h[m], h[m-1]);
+            }
+        }
+
+        Real r = a[0] + h[0];
+        Real A = 0.0, B = 0.0, C = 0.0;
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            if (d > 0 && r <= a[d]) break;
+            const Real w = Real(1.0) / (h[d]*h[d]);
+            A += w;
+            B += w*a[d];
+            C += w*a[d]*a[d];
+            r = (B + std::sqrt(amrex::max(B*B-A*(C-Real(1.0)), Real(0.0)))) / A;
+        }
+        if (r < u(i,j,k)) u(i,j,k) = r;
+    }
+
+    // Gauss-Seidel sweeps over bx in all directions.  On GPU, the nodes are
+    // relaxed in place in parallel, which also converges because the values
+    // only decrease, but it takes more rounds.
+    void sd_sweep (Box const& bx, Array4<Real> const& u, Array4<Real const> const& src,
+                   Real far, GpuArray<Real,AMREX_SPACEDIM> const& dx)
+    {
+        constexpr int nsweeps = 1 << AMREX_SPACEDIM;
+        if (Gpu::inLaunchRegion())
+        {
+            for (int s = 0; s < nsweeps; ++s) {
+                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    sd_relax(i, j, k, u, src, far, dx);
+                });
+            }
+        }
+        else
+        {
+            const auto lo = amrex::lbound(bx);
+            const auto len = amrex::length(bx);
+            for (int s = 0; s < nsweeps; ++s) {
+                for         (int kk = 0; kk < len.z; ++kk) {
+                    const int k = (s & 4) ? lo.z+len.z-1-kk : lo.z+kk;
+                    for     (int jj = 0; jj < len.y; ++jj) {
+                        const int j = (s & 2) ? lo.y+len.y-1-jj : lo.y+jj;
+                        for (int ii = 0; ii < len.x; ++ii) {
+                            const int i = (s & 1) ? lo.x+len.x-1-ii : lo.x+ii;
+                            sd_relax(i, j, k, u, src, far, dx);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+EBSignedDistance::EBSignedDistance (const BoxArray& ba, const DistributionMapping& dm,
+                                    Real band_width, bool fluid_has_positive_sign)
+    : m_band_width(band_width),
+      m_fluid_has_positive_sign(fluid_has_positive_sign)
+{
+    AMREX_ALWAYS_ASSERT(band_width > Real(0.0));
+    const BoxArray& nba = amrex::convert(ba, IntVect::TheNodeVector());
+    m_src.define(nba, dm, 1, 0);
+    m_udist.define(nba, dm, 1, 1);
+    m_dist.define(nba, dm, 1, 0);
+}
+
+void
+EBSignedDistance::fillInitial (const EB2::Level& eb_level, MultiFab& src) const
+{
+    const Geometry& geom = eb_level.Geom();
+    const BoxArray& ccba = amrex::convert(src.boxArray(), IntVect::TheCellVector());
+    const DistributionMapping& dm = src.DistributionMap();
+
+    // The cells around the nodes of a box
+    FabArray<EBCellFlagFab> cellflag(ccba, dm, 1, 1);
+    cellflag.setVal(EBCellFlag::TheDefaultCell());
+    eb_level.fillEBCellFlag(cellflag, geom);
+    MultiFab bndrycent(ccba, dm, AMREX_SPACEDIM, 1);
+    eb_level.fillBndryCent(bndrycent, geom);
+    MultiFab bndrynorm(ccba, dm, AMREX_SPACEDIM, 1);
+    eb_level.fillBndryNorm(bndrynorm, geom);
+
+    eb_level.fillLevelSet(src, geom);
+
+    const auto dx = geom.CellSizeArray();
+    const Real far = std::numeric_limits<Real>::max();
+    const bool fluid_positive = m_fluid_has_positive_sign;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(src,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& ls = src.array(mfi);
+        Array4<EBCellFlag const> const& flag = cellflag.const_array(mfi);
+        Array4<Real const> const& bc = bndrycent.const_array(mfi);
+        Array4<Real const> const& bn = bndrynorm.const_array(mfi);
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            const Real l = ls(i,j,k);
+            if (l == Real(0.0)) return;
+            // Distance to the planes of the facets of the cut cells around the node
+            Real d = far;
+            const int klo = (AMREX_SPACEDIM == 3) ? k-1 : k;
+            for         (int kk = klo; kk <= k; ++kk) {
+                for     (int jj = j-1; jj <= j; ++jj) {
+                    for (int ii = i-1; ii <= i; ++ii) {
+                        if (flag(ii,jj,kk).isSingleValued()) {
+                            Real dist = AMREX_D_TERM
+                                ((i-ii-Real(0.5)-bc(ii,jj,kk,0))*dx[0]*bn(ii,jj,kk,0),
+                                +(j-jj-Real(0.5)-bc(ii,jj,kk,1))*dx[1]*bn(ii,jj,kk,1),
+                                +(k-kk-Real(0.5)-bc(ii,jj,kk,2))*dx[2]*bn(ii,jj,kk,2));
+                            d = amrex::min(d, amrex::Math::abs(dist));
+                        }
+                    }
+                }
+            }
+            ls(i,j,k) = ((l < Real(0.0)) == fluid_positive) ? d : -d;
+        });
+    }
+}
+
+void
+EBSignedDistance::update (const EB2::Level& eb_level)
+{
+    BL_PROFILE("EBSignedDistance::update()");
+
+    m_geom = eb_level.Geom();
+
+    const Real band = m_band_width;
+    const Real far = std::numeric_limits<Real>::max();
+    Vector<int> active(m_udist.local_size(), 0);
+
+    if (!m_defined)
+    {
+        fillInitial(eb_level, m_src);
+        m_udist.setVal(band);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(m_udist); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            Array4<Real> const& u = m_udist.array(mfi);
+            Array4<Real const> const& src = m_src.const_array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                u(i,j,k) = amrex::min(amrex::Math::abs(src(i,j,k)), band);
+            });
+            active[mfi.LocalIndex()] = Reduce::AnyOf(bx,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    return amrex::Math::abs(src(i,j,k)) != far;
+                });
+        }
+
+        m_defined = true;
+    }
+    else
+    {
+        MultiFab src(m_src.boxArray(), m_src.DistributionMap(), 1, 0);
+        fillInitial(eb_level, src);
+
+        // The cells around the nodes whose initial values have changed,
+        // grown by the band width, are computed again.
+        const auto dx = m_geom.CellSizeArray();
+        const int nband = static_cast<int>(std::ceil(band / amrex::min(AMREX_D_DECL(dx[0],dx[1],dx[2])))) + 1;
+        Vector<Box> reset_boxes;
+        for (MFIter mfi(src); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            Array4<Real const> const& snew = src.const_array(mfi);
+            Array4<Real const> const& sold = m_src.const_array(mfi);
+            ReduceOps<AMREX_D_DECL(ReduceOpMin,ReduceOpMin,ReduceOpMin),
+                      AMREX_D_DECL(ReduceOpMax,ReduceOpMax,ReduceOpMax)> reduce_op;
+            ReduceData<AMREX_D_DECL(int,int,int),AMREX_D_DECL(int,int,int)> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                amrex::ignore_unused(j,k);
+                if (snew(i,j,k) != sold(i,j,k)) {
+                    return {AMREX_D_DECL(i,j,k),AMREX_D_DECL(i,j,k)};
+                } else {
+                    return {AMREX_D_DECL(std::numeric_limits<int>::max(),
+                                         std::numeric_limits<int>::max(),
+                                         std::numeric_limits<int>::max()),
+                            AMREX_D_DECL(std::numeric_limits<int>::lowest(),
+                                         std::numeric_limits<int>::lowest(),
+                                         std::numeric_limits<int>::lowest())};
+                }
+            });
+            ReduceTuple hv = reduce_data.value(reduce_op);
+            IntVect lo(AMREX_D_DECL(amrex::get<0>(hv), amrex::get<1>(hv), amrex::get<2>(hv)));
+#if (AMREX_SPACEDIM == 3)
+            IntVect hi(amrex::get<3>(hv), amrex::get<4>(hv), amrex::get<5>(hv));
+#elif (AMREX_SPACEDIM == 2)
+            IntVect hi(amrex::get<2>(hv), amrex::get<3>(hv));
+#endif
+            if (lo.allLE(hi)) {
+                // cells around the nodes lo to hi
+                reset_boxes.push_back(amrex::grow(Box(lo-1, hi), nband));
+            }
+        }
+
+        amrex::AllGatherBoxes(reset_boxes);
+        std::swap(m_src, src);
+
+        if (!reset_boxes.empty())
+        {
+            const BoxArray reset_ba(BoxList(std::move(reset_boxes)));
+            const std::vector<IntVect>& pshifts = m_geom.periodicity().shiftIntVect();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            {
+                std::vector<std::pair<int,Box> > isects;
+                for (MFIter mfi(m_udist); mfi.isValid(); ++mfi)
+                {
+                    const Box& bx = mfi.validbox();
+                    const Box& ccbx = amrex::enclosedCells(bx);
+                    Array4<Real> const& u = m_udist.array(mfi);
+                    Array4<Real const> const& s = m_src.const_array(mfi);
+                    for (const auto& iv : pshifts)
+                    {
+                        reset_ba.intersections(amrex::grow(ccbx,1)+iv, isects);
+                        for (const auto& is : isects)
+                        {
+                            const Box& rbx = amrex::surroundingNodes(is.second-iv) & bx;
+                            if (rbx.ok()) {
+                                active[mfi.LocalIndex()] = 1;
+                                amrex::ParallelFor(rbx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                                {
+                                    u(i,j,k) = amrex::min(amrex::Math::abs(s(i,j,k)), band);
+                                });
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    sweep(active);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(m_dist,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& d = m_dist.array(mfi);
+        Array4<Real const> const& u = m_udist.const_array(mfi);
+        Array4<Real const> const& s = m_src.const_array(mfi);
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            d(i,j,k) = (s(i,j,k) < Real(0.0)) ? -u(i,j,k) : u(i,j,k);
+        });
+    }
+
+    // The nodes shared by boxes may differ by round-off.
+    m_dist.OverrideSync(m_geom.periodicity());
+}
+
+void
+EBSignedDistance::sweep (Vector<int>& active)
+{
+    const auto dx = m_geom.CellSizeArray();
+    const Real far = std::numeric_limits<Real>::max();
+    const Real tol = Real(10.0) * std::numeric_limits<Real>::epsilon() * m_band_width;
+
+    m_udist.FillBoundary(m_geom.periodicity());
+    MultiFab prev(m_udist.boxArray(), m_udist.DistributionMap(), 1, 1);
+    MultiFab::Copy(prev, m_udist, 0, 0, 1, 1);
+
+    m_nrounds = 0;
+    for (;;)
+    {
+        int nactive = 0;
+        for (int a : active) { nactive += a; }
+        ParallelAllReduce::Sum(nactive, ParallelContext::CommunicatorSub());
+        if (nactive == 0) break;
+
+        // Boxes far from the EB are cheap, those with many nodes near it
+        // are not, hence the dynamic schedule.
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(m_udist, MFItInfo().SetDynamic(true)); mfi.isValid(); ++mfi)
+        {
+            if (!active[mfi.LocalIndex()]) continue;
+            sd_sweep(mfi.validbox(), m_udist.array(mfi), m_src.const_array(mfi), far, dx);
+        }
+
+        m_udist.FillBoundary(m_geom.periodicity());
+
+        // A box is swept again if its nodes or ghost nodes have changed.
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(m_udist); mfi.isValid(); ++mfi)
+        {
+            const Box& gbx = mfi.fabbox();
+            Array4<Real const> const& u = m_udist.const_array(mfi);
+            Array4<Real> const& p = prev.array(mfi);
+            active[mfi.LocalIndex()] = Reduce::AnyOf(gbx,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    return u(i,j,k) < p(i,j,k) - tol;
+                });
+            amrex::ParallelFor(gbx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                p(i,j,k) = u(i,j,k);
+            });
+        }
+
+        ++m_nrounds;
+    }
+}
+
+}
@@ -1,6 +1,10 @@
 #include <AMReX_EBToPVD.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Dim3.H>
+#include <AMReX_NFiles.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_Utility.H>
 
 #include <string>
 #include <sstream>
@@ -8,6 +12,9 @@
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
 
 namespace {
 amrex::Real dot_product(const std::array<amrex::Real,3>& a, const std::array<amrex::Real,3>& b)
@@ -20,6 +27,27 @@ bool intersects(amrex::Real val)
    return (val > 0.0 && val < 1.0);
 }
 
+struct EdgeHash
+{
+   std::size_t operator()(const std::array<int,4>& e) const noexcept
+   {
+      std::size_t h = static_cast<std::size_t>(e[0]);
+      for(int n = 1; n < 4; ++n) {
+         h = h*1000003u ^ static_cast<std::size_t>(static_cast<unsigned int>(e[n]));
+      }
+      return h;
+   }
+};
+
+// Writes one block of raw appended VTK data preceded by its size in bytes
+template <typename T>
+void write_appended(std::ostream& os, const std::vector<T>& v)
+{
+   const std::uint64_t nbytes = v.size()*sizeof(T);
+   os.write(reinterpret_cast<const char*>(&nbytes), sizeof(nbytes));
+   os.write(reinterpret_cast<const char*>(v.data()), nbytes);
+}
+
 }
 
 namespace amrex {
@@ -166,10 +194,17 @@ void EBToPVD::EBToPolygon(const Real* problo, const Real* dx,
                      apoints[11][idim] = vertex[4][idim] + jhat[idim]*dx[1]*alpha[11];
                   }
 
+                  // direction and lower node of the cell edge of each intersection
+                  const std::array<std::array<int,4>,12> aedges = {{
+                     {0,i  ,j  ,k  }, {1,i+1,j  ,k  }, {0,i  ,j+1,k  }, {1,i  ,j  ,k  },
+                     {2,i  ,j  ,k  }, {2,i+1,j  ,k  }, {2,i+1,j+1,k  }, {2,i  ,j+1,k  },
+                     {0,i  ,j  ,k+1}, {1,i+1,j  ,k+1}, {0,i  ,j+1,k+1}, {1,i  ,j  ,k+1}}};
+
                   // store intersections with grid cell alpha in [0,1]
                   for(int lc1 = 0; lc1 < 12; ++lc1) {
                      if(alpha_intersect[lc1]) {
                         m_points.push_back(apoints[lc1]);
+                        m_point_edges.push_back(aedges[lc1]);
                         int lc2 = m_connectivity.back()[0]+1;
                         m_connectivity.back()[0] = lc2;
                         m_connectivity.back()[lc2] = m_points.size()-1;
@@ -237,6 +272,167 @@ void EBToPVD::WritePVTP(const int nProcs) const
       myfile.close();
    }
 }
+void EBToPVD::WriteEBVTPNFiles(const std::string& prefix, int nfiles) const
+{
+   // Merge the points that lie on the same cell edge. Each cell computes
+   // them from its own plane, so the merged point is the average.
+   std::vector<float> points;
+   std::vector<int> connectivity;
+   std::vector<int> offsets;
+   {
+      std::unordered_map<std::array<int,4>,int,EdgeHash> edge_to_point;
+      edge_to_point.reserve(m_points.size());
+      std::vector<std::array<double,3>> sum;
+      std::vector<int> count;
+      std::vector<int> point_id(m_points.size());
+      for(size_t lc1 = 0; lc1 < m_points.size(); ++lc1) {
+         auto r = edge_to_point.emplace(m_point_edges[lc1], static_cast<int>(sum.size()));
+         if(r.second) {
+            sum.push_back({0.0, 0.0, 0.0});
+            count.push_back(0);
+         }
+         const int id = r.first->second;
+         for(int idim = 0; idim < 3; ++idim) {
+            sum[id][idim] += m_points[lc1][idim];
+         }
+         ++count[id];
+         point_id[lc1] = id;
+      }
+
+      points.resize(3*sum.size());
+      for(size_t lc1 = 0; lc1 < sum.size(); ++lc1) {
+         for(int idim = 0; idim < 3; ++idim) {
+            points[3*lc1+idim] = static_cast<float>(sum[lc1][idim]/count[lc1]);
+         }
+      }
+
+      offsets.reserve(m_connectivity.size());
+      for(size_t lc1 = 0; lc1 < m_connectivity.size(); ++lc1) {
+         for(int lc2 = 1; lc2 <= m_connectivity[lc1][0]; ++lc2) {
+            connectivity.push_back(point_id[m_connectivity[lc1][lc2]]);
+         }
+         AMREX_ALWAYS_ASSERT(connectivity.size() <= static_cast<size_t>(std::numeric_limits<int>::max()));
+         offsets.push_back(static_cast<int>(connectivity.size()));
+      }
+   }
+
+   // Every process needs to know the sizes of all the pieces in its file.
+   const int nprocs = ParallelDescriptor::NProcs();
+   const int myproc = ParallelDescriptor::MyProc();
+   std::array<Long,3> mysizes = {static_cast<Long>(points.size()/3),
+                                 static_cast<Long>(connectivity.size()),
+                                 static_cast<Long>(offsets.size())};
+   std::vector<Long> sizes(3*nprocs);
+   std::copy(mysizes.begin(), mysizes.end(), sizes.begin()+3*myproc);
+   ParallelAllGather::AllGather(mysizes.data(), 3, sizes.data(), ParallelDescriptor::Communicator());
+
+   // With groupSets = false the processes of a file are contiguous and
+   // write in increasing order.
+   nfiles = NFilesIter::ActualNFiles(nfiles);
+   const int my_file_number = NFilesIter::FileNumber(nfiles, myproc, false);
+   int first_proc = nprocs, last_proc = -1;
+   std::vector<int> file_has_data(nfiles, 0);
+   for(int iproc = 0; iproc < nprocs; ++iproc) {
+      const int ifile = NFilesIter::FileNumber(nfiles, iproc, false);
+      if(sizes[3*iproc] > 0) file_has_data[ifile] = 1;
+      if(ifile == my_file_number) {
+         first_proc = std::min(first_proc, iproc);
+         last_proc = std::max(last_proc, iproc);
+      }
+   }
+
+   const std::uint16_t one = 1;
+   const bool little_endian = *reinterpret_cast<const unsigned char*>(&one) == 1;
+
+   std::string header;
+   if(myproc == first_proc) {
+      std::ostringstream os;
+      os << "<?xml version=\"1.0\"?>\n";
+      os << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\""
+         << (little_endian ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\">\n";
+      os << "<PolyData>\n";
+      if(!file_has_data[my_file_number]) {
+         os << "<Piece NumberOfPoints=\"0\" NumberOfVerts=\"0\" NumberOfLines=\"0\" "
+            << "NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n</Piece>\n";
+      }
+      std::uint64_t offset = 0;
+      for(int iproc = first_proc; iproc <= last_proc; ++iproc) {
+         const Long npoints = sizes[3*iproc];
+         const Long nconnect = sizes[3*iproc+1];
+         const Long npolys = sizes[3*iproc+2];
+         if(npoints == 0) continue;
+         os << "<Piece NumberOfPoints=\"" << npoints << "\" NumberOfVerts=\"0\" NumberOfLines=\"0\" "
+            << "NumberOfStrips=\"0\" NumberOfPolys=\"" << npolys << "\">\n";
+         os << "<Points>\n";
+         os << "<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"appended\" offset=\""
+            << offset << "\"/>\n";
+         os << "</Points>\n";
+         offset += sizeof(std::uint64_t) + 3*sizeof(float)*npoints;
+         os << "<Polys>\n";
+         os << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\""
+            << offset << "\"/>\n";
+         offset += sizeof(std::uint64_t) + sizeof(int)*nconnect;
+         os << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\""
+            << offset << "\"/>\n";
+         offset += sizeof(std::uint64_t) + sizeof(int)*npolys;
+         os << "</Polys>\n";
+         os << "</Piece>\n";
+      }
+      os << "</PolyData>\n";
+      os << "<AppendedData encoding=\"raw\">\n_";
+      header = os.str();
+   }
+
+   const std::string file_prefix = prefix + "_";
+   for(NFilesIter nfi(nfiles, file_prefix, false, true); nfi.ReadyToWrite(); ++nfi) {
+      auto& os = nfi.Stream();
+      if(myproc == first_proc) {
+         os.write(header.data(), header.size());
+      }
+      if(!points.empty()) {
+         write_appended(os, points);
+         write_appended(os, connectivity);
+         write_appended(os, offsets);
+      }
+      if(myproc == last_proc) {
+         os << "\n</AppendedData>\n";
+         os << "</VTKFile>\n";
+      }
+   }
+
+   // NFilesIter does not add a suffix; ParaView picks the reader by it.
+   if(myproc == last_proc) {
+      const std::string fname = NFilesIter::FileName(my_file_number, file_prefix);
+      if(std::rename(fname.c_str(), (fname + ".vtp").c_str()) != 0) {
+         amrex::Abort("EBToPVD::WriteEBVTPNFiles: failed to rename " + fname);
+      }
+   }
+
+   if(ParallelDescriptor::IOProcessor()) {
+      const std::string base = file_prefix.substr(file_prefix.find_last_of('/')+1);
+      std::ofstream myfile(prefix + ".pvtp");
+      if(!myfile.good()) {
+         amrex::FileOpenFailed(prefix + ".pvtp");
+      }
+      myfile << "<?xml version=\"1.0\"?>\n";
+      myfile << "<VTKFile type=\"PPolyData\" version=\"1.0\" byte_order=\""
+             << (little_endian ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\">\n";
+      myfile << "<PPolyData GhostLevel=\"0\">\n";
+      myfile << "<PPointData/>\n";
+      myfile << "<PCellData/>\n";
+      myfile << "<PPoints>\n";
+      myfile << "<PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n";
+      myfile << "</PPoints>\n";
+      for(int ifile = 0; ifile < nfiles; ++ifile) {
+         if(file_has_data[ifile]) {
+            myfile << "<Piece Source=\"" << NFilesIter::FileName(ifile, base) << ".vtp\"/>\n";
+         }
+      }
+      myfile << "</PPolyData>\n";
+      myfile << "</VTKFile>\n";
+   }
+}
+
 void EBToPVD::reorder_polygon(const std::vector<std::array<Real,3>>& lpoints,
       std::array<int,7>& lconnect,
       const std::array<Real,3>& lnormal)
@@ -1,22 +1,76 @@
 #include<AMReX_EB_STL_utils.H>
 #include<AMReX_EB_triGeomOps_K.H>
 
+#include<algorithm>
+#include<cstdint>
+#include<cstring>
+#include<functional>
+
 namespace amrex
 {
+    //================================================================================
+    void STLtools::read_stl_file(std::string fname)
+    {
+        Vector<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(fname, fileCharPtr);
+
+        if(amrex::Verbose())
+            Print()<<"STL file name:"<<fname<<"\n";
+
+        //a binary STL has an 80-byte header, the number of triangles,
+        //and 50 bytes per triangle.  An ASCII STL may start with anything.
+        Long fileLength = static_cast<Long>(fileCharPtr.size())-1;
+        bool is_binary = false;
+        if(fileLength >= 84)
+        {
+            std::uint32_t ntri;
+            std::memcpy(&ntri, fileCharPtr.dataPtr()+80, sizeof(ntri));
+            is_binary = (fileLength == 84 + 50*static_cast<Long>(ntri));
+        }
+
+        if(is_binary)
+        {
+            parse_binary_stl(fileCharPtr);
+        }
+        else
+        {
+            parse_ascii_stl(fileCharPtr);
+        }
+        build_bvh();
+    }
     //================================================================================
     void STLtools::read_ascii_stl_file(std::string fname)
     {
-        std::string tmpline,tmp1,tmp2;
-        int nlines=0;
+        Vector<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(fname, fileCharPtr);
 
+        if(amrex::Verbose())
+            Print()<<"STL file name:"<<fname<<"\n";
+
+        parse_ascii_stl(fileCharPtr);
+        build_bvh();
+    }
+    //================================================================================
+    void STLtools::read_binary_stl_file(std::string fname)
+    {
         Vector<char> fileCharPtr;
         ParallelDescriptor::ReadAndBcastFile(fname, fileCharPtr);
-        std::string fileCharPtrString(fileCharPtr.dataPtr());
-        std::istringstream infile(fileCharPtrString, std::istringstream::in);
 
         if(amrex::Verbose())
             Print()<<"STL file name:"<<fname<<"\n";
 
+        parse_binary_stl(fileCharPtr);
+        build_bvh();
+    }
+    //================================================================================
+    void STLtools::parse_ascii_stl(const Vector<char>& fileCharPtr)
+    {
+        std::string tmpline,tmp1,tmp2;
+        int nlines=0;
+
+        std::string fileCharPtrString(fileCharPtr.dataPtr());
+        std::istringstream infile(fileCharPtrString, std::istringstream::in);
+
         std::getline(infile,tmpline); //solid <solidname>
         while(!infile.eof())
         {
@@ -80,6 +134,162 @@ namespace amrex
             std::getline(infile,tmpline); //end loop
             std::getline(infile,tmpline); //end facet
         }
+    }
+    //================================================================================
+    void STLtools::parse_binary_stl(const Vector<char>& fileCharPtr)
+    {
+        //80-byte header, number of triangles, and for each triangle, the normal
+        //and the three vertices as 32-bit floats and a 2-byte attribute
+        Long fileLength = static_cast<Long>(fileCharPtr.size())-1;
+        if(fileLength < 84)
+        {
+            Abort("binary STL file is too short\n");
+        }
+
+        const char* buf = fileCharPtr.dataPtr();
+        std::uint32_t ntri;
+        std::memcpy(&ntri, buf+80, sizeof(ntri));
+        if(fileLength != 84 + 50*static_cast<Long>(ntri))
+        {
+            Abort("size of the binary STL file does not match its number of triangles\n");
+        }
+        AMREX_ALWAYS_ASSERT(ntri <= static_cast<std::uint32_t>(std::numeric_limits<int>::max()/m_ndata_per_tri));
+
+        m_num_tri=static_cast<int>(ntri);
+
+        if(amrex::Verbose())
+            Print()<<"number of triangles:"<<m_num_tri<<"\n";
+
+        m_tri_pts_h.resize(m_num_tri*m_ndata_per_tri);
+        m_tri_normals_h.resize(m_num_tri*m_ndata_per_normal);
+
+        for(int i=0;i<m_num_tri;i++)
+        {
+            float data[12];
+            std::memcpy(data, buf+84+50*static_cast<Long>(i), sizeof(data));
+            for(int n=0;n<m_ndata_per_normal;n++)
+            {
+                m_tri_normals_h[i*m_ndata_per_normal+n]=data[n];
+            }
+            for(int n=0;n<m_ndata_per_tri;n++)
+            {
+                m_tri_pts_h[i*m_ndata_per_tri+n]=data[3+n];
+            }
+        }
+    }
+    //================================================================================
+    void STLtools::build_bvh()
+    {
+        //median split on the longest extent of the triangle centroids.
+        //The nodes are stored in depth-first order.
+        const int ntri=m_num_tri;
+        Vector<int> index(ntri);
+        Vector<Real> centroid(ntri*3);
+        for(int i=0;i<ntri;i++)
+        {
+            index[i]=i;
+            for(int dir=0;dir<3;dir++)
+            {
+                centroid[i*3+dir]=(m_tri_pts_h[i*m_ndata_per_tri+dir]
+                                  +m_tri_pts_h[i*m_ndata_per_tri+3+dir]
+                                  +m_tri_pts_h[i*m_ndata_per_tri+6+dir])/Real(3.0);
+            }
+        }
+
+        Vector<STLBVHNode> nodes;
+        nodes.reserve(ntri > 0 ? 2*(ntri/m_max_tri_per_leaf+1) : 0);
+
+        std::function<int(int,int)> build = [&] (int begin, int end) -> int
+        {
+            const int inode=static_cast<int>(nodes.size());
+            nodes.push_back(STLBVHNode{});
+            STLBVHNode nd;
+            Real clo[3],chi[3];
+            for(int dir=0;dir<3;dir++)
+            {
+                nd.lo[dir]=clo[dir]= std::numeric_limits<Real>::max();
+                nd.hi[dir]=chi[dir]=-std::numeric_limits<Real>::max();
+            }
+            for(int i=begin;i<end;i++)
+            {
+                const int tr=index[i];
+                for(int v=0;v<3;v++)
+                {
+                    for(int dir=0;dir<3;dir++)
+                    {
+                        Real x=m_tri_pts_h[tr*m_ndata_per_tri+v*3+dir];
+                        nd.lo[dir]=amrex::min(nd.lo[dir],x);
+                        nd.hi[dir]=amrex::max(nd.hi[dir],x);
+                    }
+                }
+                for(int dir=0;dir<3;dir++)
+                {
+                    clo[dir]=amrex::min(clo[dir],centroid[tr*3+dir]);
+                    chi[dir]=amrex::max(chi[dir],centroid[tr*3+dir]);
+                }
+            }
+
+            if(end-begin <= m_max_tri_per_leaf)
+            {
+                nd.right=-1;
+                nd.first=begin;
+                nd.ntri=end-begin;
+            }
+            else
+            {
+                int dir=0;
+                if(chi[1]-clo[1] > chi[dir]-clo[dir]) dir=1;
+                if(chi[2]-clo[2] > chi[dir]-clo[dir]) dir=2;
+                const int mid=begin+(end-begin)/2;
+                std::nth_element(index.begin()+begin, index.begin()+mid, index.begin()+end,
+                                 [&] (int a, int b) {
+                                     return centroid[a*3+dir] < centroid[b*3+dir]
+                                         || (centroid[a*3+dir] == centroid[b*3+dir] && a < b);
+                                 });
+                build(begin,mid);
+                nd.right=build(mid,end);
+                nd.first=0;
+                nd.ntri=0;
+            }
+            nodes[inode]=nd;
+            return inode;
+        };
+        if(ntri > 0) build(0,ntri);
+
+        //reorder the triangles to make the leaves contiguous
+        Gpu::PinnedVector<Real> pts(m_tri_pts_h.size());
+        Gpu::PinnedVector<Real> normals(m_tri_normals_h.size());
+        for(int i=0;i<ntri;i++)
+        {
+            const int tr=index[i];
+            for(int n=0;n<m_ndata_per_tri;n++)
+            {
+                pts[i*m_ndata_per_tri+n]=m_tri_pts_h[tr*m_ndata_per_tri+n];
+            }
+            for(int n=0;n<m_ndata_per_normal;n++)
+            {
+                normals[i*m_ndata_per_normal+n]=m_tri_normals_h[tr*m_ndata_per_normal+n];
+            }
+        }
+        std::swap(m_tri_pts_h,pts);
+        std::swap(m_tri_normals_h,normals);
+
+        m_bvh_h.resize(nodes.size());
+        std::copy(nodes.begin(), nodes.end(), m_bvh_h.begin());
+
+        //a point outside of the bounding box, not in a symmetry plane of it
+        if(ntri > 0)
+        {
+            const Real fac[3]={Real(0.5381),Real(0.7129),Real(0.6197)};
+            for(int dir=0;dir<3;dir++)
+            {
+                Real len=m_bvh_h[0].hi[dir]-m_bvh_h[0].lo[dir];
+                m_outside_point[dir]=m_bvh_h[0].hi[dir]+fac[dir]*len+Real(1.0);
+            }
+        }
+
+        if(amrex::Verbose())
+            Print()<<"number of BVH nodes:"<<m_bvh_h.size()<<"\n";
 
         //device vectors
         m_tri_pts_d.resize(m_num_tri*m_ndata_per_tri);
@@ -90,22 +300,48 @@ namespace amrex
         Gpu::copy(Gpu::hostToDevice,
                 m_tri_normals_h.begin(), m_tri_normals_h.end(),
                 m_tri_normals_d.begin());
+
+        m_bvh_d.resize(m_bvh_h.size());
+        Gpu::copy(Gpu::hostToDevice, m_bvh_h.begin(), m_bvh_h.end(), m_bvh_d.begin());
+        Gpu::streamSynchronize();
+    }
+    //================================================================================
+    STLQuery STLtools::deviceQuery() const
+    {
+        STLQuery q;
+        q.nodes=m_bvh_d.data();
+        q.tri_pts=m_tri_pts_d.data();
+        q.num_tri=m_num_tri;
+        q.use_winding=m_use_winding;
+        for(int dir=0;dir<3;dir++)
+        {
+            q.outside_point[dir]=m_outside_point[dir];
+        }
+        return q;
+    }
+    //================================================================================
+    STLQuery STLtools::hostQuery() const
+    {
+        STLQuery q=deviceQuery();
+        q.nodes=m_bvh_h.data();
+        q.tri_pts=m_tri_pts_h.data();
+        return q;
     }
     //================================================================================
     void STLtools::stl_to_markerfab(MultiFab& markerfab,Geometry geom,
             Real *point_outside)
     {
         //local variables for lambda capture
-        int data_stride   = m_ndata_per_tri;
-        int num_triangles = m_num_tri;
         Real outvalue     = m_outside;
         Real invalue      = m_inside;
 
         const auto plo   = geom.ProbLoArray();
         const auto dx    = geom.CellSizeArray();
-        GpuArray<Real,3> outp={point_outside[0],point_outside[1],point_outside[2]};
 
-        const Real *tri_pts=m_tri_pts_d.data();
+        STLQuery query = deviceQuery();
+        query.outside_point[0]=point_outside[0];
+        query.outside_point[1]=point_outside[1];
+        query.outside_point[2]=point_outside[2];
 
         for (MFIter mfi(markerfab); mfi.isValid(); ++mfi) // Loop over grids
         {
@@ -114,46 +350,25 @@ namespace amrex
 
             ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k)
             {
-                Real coords[3],po[3];
-                Real t1[3],t2[3],t3[3];
+                Real coords[3];
 
                 coords[0]=plo[0]+i*dx[0];
                 coords[1]=plo[1]+j*dx[1];
+#if (AMREX_SPACEDIM == 3)
                 coords[2]=plo[2]+k*dx[2];
+#else
+                amrex::ignore_unused(k);
+                coords[2]=0.0;
+#endif
 
-                po[0]=outp[0];
-                po[1]=outp[1];
-                po[2]=outp[2];
-
-                int num_intersects=0;
-                int intersect;
-
-                for(int tr=0;tr<num_triangles;tr++)
+                if(query.inside(coords))
                 {
-                    t1[0]=tri_pts[tr*data_stride+0];
-                    t1[1]=tri_pts[tr*data_stride+1];
-                    t1[2]=tri_pts[tr*data_stride+2];
-
-                    t2[0]=tri_pts[tr*data_stride+3];
-                    t2[1]=tri_pts[tr*data_stride+4];
-                    t2[2]=tri_pts[tr*data_stride+5];
-
-                    t3[0]=tri_pts[tr*data_stride+6];
-                    t3[1]=tri_pts[tr*data_stride+7];
-                    t3[2]=tri_pts[tr*data_stride+8];
-
-                    intersect = tri_geom_ops::lineseg_tri_intersect(po,coords,t1,t2,t3);
-                    num_intersects += (1-intersect);
-                }
-                if(num_intersects%2 == 0)
-                {
-                    mfab_arr(i,j,k)=outvalue;
+                    mfab_arr(i,j,k)=invalue;
                 }
                 else
                 {
-                    mfab_arr(i,j,k)=invalue;
+                    mfab_arr(i,j,k)=outvalue;
                 }
-
             });
         }
     }
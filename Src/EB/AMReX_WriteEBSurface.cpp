@@ -7,19 +7,18 @@
 #include <AMReX_EB2.H>
 #include <AMReX_WriteEBSurface.H>
 #include <AMReX_EBToPVD.H>
+#include <AMReX_VisMF.H>
 
 namespace amrex {
 
-void WriteEBSurface (const BoxArray & ba, const DistributionMapping & dmap, const Geometry & geom,
-                     const EBFArrayBoxFactory * ebf) {
+namespace {
 
-    EBToPVD eb_to_pvd;
+void BuildEBPolygons (EBToPVD & eb_to_pvd, const MultiFab & mf_ba, const Geometry & geom,
+                      const EBFArrayBoxFactory * ebf) {
 
     const Real* dx     = geom.CellSize();
     const Real* problo = geom.ProbLo();
 
-    MultiFab mf_ba(ba, dmap, 1, 0, MFInfo(), *ebf);
-
     for (MFIter mfi(mf_ba); mfi.isValid(); ++mfi) {
 
         const auto & sfab    = static_cast<EBFArrayBox const &>(mf_ba[mfi]);
@@ -44,6 +43,21 @@ void WriteEBSurface (const BoxArray & ba, const DistributionMapping & dmap, cons
                 areafrac[1]->const_array(mfi),
                 areafrac[2]->const_array(mfi));
     }
+}
+
+}
+
+void WriteEBSurface (const BoxArray & ba, const DistributionMapping & dmap, const Geometry & geom,
+                     const EBFArrayBoxFactory * ebf) {
+
+    EBToPVD eb_to_pvd;
+
+    const Real* dx     = geom.CellSize();
+    const Real* problo = geom.ProbLo();
+
+    MultiFab mf_ba(ba, dmap, 1, 0, MFInfo(), *ebf);
+
+    BuildEBPolygons(eb_to_pvd, mf_ba, geom, ebf);
 
     int cpu = ParallelDescriptor::MyProc();
     int nProcs = ParallelDescriptor::NProcs();
@@ -67,5 +81,21 @@ void WriteEBSurface (const BoxArray & ba, const DistributionMapping & dmap, cons
     }
 }
 
+void WriteEBSurfaceVTP (const std::string & prefix, const BoxArray & ba,
+                        const DistributionMapping & dmap, const Geometry & geom,
+                        const EBFArrayBoxFactory * ebf, int nfiles) {
+
+    BL_PROFILE("WriteEBSurfaceVTP()");
+
+    EBToPVD eb_to_pvd;
+
+    MultiFab mf_ba(ba, dmap, 1, 0, MFInfo(), *ebf);
+
+    BuildEBPolygons(eb_to_pvd, mf_ba, geom, ebf);
+
+    if (nfiles <= 0) nfiles = VisMF::GetNOutFiles();
+
+    eb_to_pvd.WriteEBVTPNFiles(prefix, nfiles);
 }
 
+}
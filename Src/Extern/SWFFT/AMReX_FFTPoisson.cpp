@@ -0,0 +1,250 @@
+#include <AMReX_FFTPoisson.H>
+#include <AMReX_ParallelContext.H>
+#include <AMReX_ParallelReduce.H>
+
+#include <Dfft.H>
+
+#include <cmath>
+#include <utility>
+
+namespace amrex {
+
+// SWFFT stores its data in row-major order, so its direction 0 is our z and
+// its direction 2 is our x.
+
+namespace {
+    // distribution_init's test of whether the pencils with the process grid
+    // np fit in the blocks of size n3 of the 3D process grid.  a and b are
+    // the distributed directions of the pencils.
+    bool pencilsFit (const int n[3], const int n3[3], const int np[3], int a, int b)
+    {
+        for (int i = 0; i < 3; ++i) {
+            if (n[i] / np[i] == 0) { return false; }
+        }
+        return n3[a] % (n[a]/np[a]) == 0 && n3[b] % (n[b]/np[b]) == 0
+            && n[0] % np[a] == 0 && n[0] % np[b] == 0;
+    }
+
+    // The choice of distribution_init for the pencils with the outer
+    // direction o.  It tries the grid of MPI_Dims_create, then the same
+    // grid with a and b swapped, and then the 3D grid with o merged into
+    // merge_first, or into the other one if that does not divide n[0] in
+    // the directions c0 and c1.
+    bool pencilsSupported (int nprocs, const int n[3], const int n3[3], const int np3[3],
+                           int o, int a, int b, int merge_first, int c0, int c1)
+    {
+        int np[3] = {0, 0, 0};
+        np[o] = 1;
+        MPI_Dims_create(nprocs, 3, np);
+        if (pencilsFit(n, n3, np, a, b)) { return true; }
+        if (n[0]/np[0] != 0 && n[1]/np[1] != 0 && n[2]/np[2] != 0 &&
+            n3[a] % (n[b]/np[b]) == 0 && n3[b] % (n[a]/np[a]) == 0)
+        {
+            std::swap(np[a], np[b]);
+            if (pencilsFit(n, n3, np, a, b)) { return true; }
+        }
+
+        const int merge_second = (merge_first == a) ? b : a;
+        np[o] = 1;
+        np[merge_first] = np3[merge_first]*np3[o];
+        np[merge_second] = np3[merge_second];
+        if (n[0] % np[c0] != 0 || n[0] % np[c1] != 0) {
+            np[merge_second] = np3[merge_second]*np3[o];
+            np[merge_first] = np3[merge_first];
+        }
+        return pencilsFit(n, n3, np, a, b);
+    }
+}
+
+bool
+FFTPoisson::isSupported (const Geometry& geom)
+{
+    const Box& domain = geom.Domain();
+    const int nprocs = ParallelContext::NProcsSub();
+    const int n[3] = {domain.length(2), domain.length(1), domain.length(0)};
+
+    int np3[3] = {0, 0, 0};
+    MPI_Dims_create(nprocs, 3, np3);
+    int n3[3];
+    for (int i = 0; i < 3; ++i) {
+        if (n[i] % np3[i] != 0 || n[0] % np3[i] != 0) { return false; }
+        n3[i] = n[i] / np3[i];
+    }
+
+    // z, x and y pencils, with the quirks of distribution_init
+    return pencilsSupported(nprocs, n, n3, np3, 2, 0, 1, (n3[0] > n3[1]) ? 1 : 0, 0, 1)
+        && pencilsSupported(nprocs, n, n3, np3, 0, 1, 2, (np3[2] > np3[1]) ? 1 : 2, 2, 0)
+        && pencilsSupported(nprocs, n, n3, np3, 1, 0, 2, (np3[2] > np3[0]) ? 0 : 2, 2, 0);
+}
+
+FFTPoisson::FFTPoisson (const Geometry& geom)
+    : m_geom(geom)
+{
+    BL_PROFILE("FFTPoisson::FFTPoisson()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_geom.isAllPeriodic(),
+                                     "FFTPoisson only supports fully periodic domains");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(isSupported(m_geom),
+                                     "FFTPoisson: SWFFT cannot decompose the domain on this number of ranks");
+
+    const Box& domain = m_geom.Domain();
+    MPI_Comm comm = ParallelContext::CommunicatorSub();
+    const int nprocs = ParallelContext::NProcsSub();
+    const int myproc = ParallelContext::MyProcSub();
+
+    int n[3] = {domain.length(2), domain.length(1), domain.length(0)};
+    m_dist = std::make_unique<hacc::Distribution>(comm, n);
+    m_dfft = std::make_unique<hacc::Dfft>(*m_dist);
+
+    // Each rank owns one block of the domain.  Gather the blocks so that we
+    // can copy between them and MultiFabs with a ParallelCopy.
+    Vector<int> corners(2*AMREX_SPACEDIM*nprocs, 0);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        const int d = 2-idim;
+        const int lo = domain.smallEnd(idim) + m_dfft->self_rspace(d)*m_dfft->local_ng_rspace(d);
+        corners[2*AMREX_SPACEDIM*myproc+idim] = lo;
+        corners[2*AMREX_SPACEDIM*myproc+AMREX_SPACEDIM+idim] = lo + m_dfft->local_ng_rspace(d) - 1;
+    }
+    ParallelAllReduce::Sum(corners.data(), static_cast<int>(corners.size()), comm);
+
+    BoxList bl;
+    Vector<int> pmap(nprocs);
+    for (int p = 0; p < nprocs; ++p) {
+        const int* c = &corners[2*AMREX_SPACEDIM*p];
+        bl.push_back(Box(IntVect(c), IntVect(c+AMREX_SPACEDIM)));
+        pmap[p] = ParallelContext::local_to_global_rank(p);
+    }
+    m_ba = BoxArray(std::move(bl));
+    m_dm = DistributionMapping(std::move(pmap));
+
+    m_a.resize(m_dfft->local_size());
+    m_b.resize(m_dfft->local_size());
+    m_dfft->makePlans(m_a.data(), m_b.data(), m_a.data(), m_b.data());
+}
+
+FFTPoisson::~FFTPoisson ()
+{}
+
+void
+FFTPoisson::solve (MultiFab& soln, const MultiFab& rhs)
+{
+    BL_PROFILE("FFTPoisson::solve()");
+
+    const int ncomp = rhs.nComp();
+    AMREX_ALWAYS_ASSERT(soln.nComp() >= ncomp);
+
+    MultiFab phi(m_ba, m_dm, ncomp, 0);
+    phi.ParallelCopy(rhs, 0, 0, ncomp);
+
+    const int* lng_k = m_dfft->local_ng_kspace();
+    const int* self_k = m_dfft->self_kspace();
+    const Real* dxinv = m_geom.InvCellSize();
+    const Real dhinv[3] = {dxinv[2]*dxinv[2], dxinv[1]*dxinv[1], dxinv[0]*dxinv[0]};
+    const int* ng = m_dfft->global_ng();
+    const Real fac = Real(1.0) / static_cast<Real>(m_dfft->global_size());
+    const Real twopi = Real(2.0)*Real(3.14159265358979323846264338327950288);
+
+    for (int n = 0; n < ncomp; ++n)
+    {
+        for (MFIter mfi(phi); mfi.isValid(); ++mfi)
+        {
+            Array4<Real> const& a = phi.array(mfi);
+            const auto lo = amrex::lbound(mfi.validbox());
+            const auto hi = amrex::ubound(mfi.validbox());
+            Long idx = 0;
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        m_a[idx++] = complex_t(a(i,j,k,n), 0.0);
+                    }
+                }
+            }
+        }
+
+        m_dfft->forward(m_a.data());
+
+        // Divide by the eigenvalues of the discrete Laplacian.  The zero mode
+        // is dropped.
+        Long idx = 0;
+        for         (int l0 = 0; l0 < lng_k[0]; ++l0) {
+            const int k0 = self_k[0]*lng_k[0] + l0;
+            const Real e0 = Real(2.0)*(std::cos(twopi*k0/ng[0])-Real(1.0))*dhinv[0];
+            for     (int l1 = 0; l1 < lng_k[1]; ++l1) {
+                const int k1 = self_k[1]*lng_k[1] + l1;
+                const Real e1 = Real(2.0)*(std::cos(twopi*k1/ng[1])-Real(1.0))*dhinv[1];
+                for (int l2 = 0; l2 < lng_k[2]; ++l2) {
+                    const int k2 = self_k[2]*lng_k[2] + l2;
+                    const Real e2 = Real(2.0)*(std::cos(twopi*k2/ng[2])-Real(1.0))*dhinv[2];
+                    if (k0 == 0 && k1 == 0 && k2 == 0) {
+                        m_a[idx] = 0.0;
+                    } else {
+                        m_a[idx] *= fac / (e0+e1+e2);
+                    }
+                    ++idx;
+                }
+            }
+        }
+
+        m_dfft->backward(m_a.data());
+
+        for (MFIter mfi(phi); mfi.isValid(); ++mfi)
+        {
+            Array4<Real> const& a = phi.array(mfi);
+            const auto lo = amrex::lbound(mfi.validbox());
+            const auto hi = amrex::ubound(mfi.validbox());
+            idx = 0;
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        a(i,j,k,n) = std::real(m_a[idx++]);
+                    }
+                }
+            }
+        }
+    }
+
+    soln.ParallelCopy(phi, 0, 0, ncomp);
+}
+
+Real
+FFTPoisson::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs,
+                   Real /*a_tol_rel*/, Real /*a_tol_abs*/)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(a_sol.size() == 1 && a_rhs.size() == 1,
+                                     "FFTPoisson only supports a single level");
+    solve(*a_sol[0], *a_rhs[0]);
+    return 0.0;
+}
+
+void
+FFTPoisson::getFluxes (const Array<MultiFab*,AMREX_SPACEDIM>& a_flux, MultiFab& soln) const
+{
+    BL_PROFILE("FFTPoisson::getFluxes()");
+
+    AMREX_ALWAYS_ASSERT(soln.nGrow() >= 1);
+    soln.FillBoundary(m_geom.periodicity());
+
+    const int ncomp = a_flux[0]->nComp();
+    const Real* dxinv = m_geom.InvCellSize();
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const IntVect iv = IntVect::TheDimensionVector(idim);
+        const Real fac = -dxinv[idim];
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(*a_flux[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            Array4<Real> const& f = a_flux[idim]->array(mfi);
+            Array4<Real const> const& s = soln.const_array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D(bx, ncomp, i, j, k, n,
+            {
+                f(i,j,k,n) = fac*(s(i,j,k,n) - s(i-iv[0],j-iv[1],k-iv[2],n));
+            });
+        }
+    }
+}
+
+}
@@ -82,6 +82,9 @@ MLABecLaplacian::define_ab_coeffs ()
             }
         }
     }
+
+    m_a_coeffs_dirty.assign(m_num_amr_levels, 1);
+    m_b_coeffs_dirty.assign(m_num_amr_levels, 1);
 }
 
 MLABecLaplacian::~MLABecLaplacian ()
@@ -97,6 +100,7 @@ MLABecLaplacian::setScalars (Real a, Real b) noexcept
         for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
         {
             m_a_coeffs[amrlev][0].setVal(0.0);
+            m_a_coeffs_dirty[amrlev] = 1;
         }
     }
 }
@@ -107,6 +111,7 @@ MLABecLaplacian::setACoeffs (int amrlev, const MultiFab& alpha)
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(alpha.nComp() == 1,
                                      "MLABecLaplacian::setACoeffs: alpha is supposed to be single component.");
     MultiFab::Copy(m_a_coeffs[amrlev][0], alpha, 0, 0, 1, 0);
+    m_a_coeffs_dirty[amrlev] = 1;
     m_needs_update = true;
 }
 
@@ -114,6 +119,7 @@ void
 MLABecLaplacian::setACoeffs (int amrlev, Real alpha)
 {
     m_a_coeffs[amrlev][0].setVal(alpha);
+    m_a_coeffs_dirty[amrlev] = 1;
     m_needs_update = true;
 }
 
@@ -135,6 +141,7 @@ MLABecLaplacian::setBCoeffs (int amrlev,
                 MultiFab::Copy(m_b_coeffs[amrlev][0][idim], *beta[idim], 0, icomp, 1, 0);
             }
         }
+    m_b_coeffs_dirty[amrlev] = 1;
     m_needs_update = true;
 }
 
@@ -144,6 +151,7 @@ MLABecLaplacian::setBCoeffs (int amrlev, Real beta)
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
         m_b_coeffs[amrlev][0][idim].setVal(beta);
     }
+    m_b_coeffs_dirty[amrlev] = 1;
     m_needs_update = true;
 }
 
@@ -156,6 +164,7 @@ MLABecLaplacian::setBCoeffs (int amrlev, Vector<Real> const& beta)
             m_b_coeffs[amrlev][0][idim].setVal(beta[icomp]);
         }
     }
+    m_b_coeffs_dirty[amrlev] = 1;
     m_needs_update = true;
 }
 
@@ -164,36 +173,54 @@ MLABecLaplacian::averageDownCoeffs ()
 {
     BL_PROFILE("MLABecLaplacian::averageDownCoeffs()");
 
-    for (int amrlev = m_num_amr_levels-1; amrlev > 0; --amrlev)
+    // Only the levels whose coefficients have been set since the last call, and the
+    // coarser levels they are averaged down to, need to be updated.  A coarse level
+    // that has been set has to get the average of the finer level again where it is
+    // covered, even if the finer level has not changed.
+    bool a_dirty = false;
+    bool b_dirty = false;
+    for (int amrlev = m_num_amr_levels-1; amrlev >= 0; --amrlev)
     {
-        auto& fine_a_coeffs = m_a_coeffs[amrlev];
-        auto& fine_b_coeffs = m_b_coeffs[amrlev];
-
-        averageDownCoeffsSameAmrLevel(amrlev, fine_a_coeffs, fine_b_coeffs);
-        averageDownCoeffsToCoarseAmrLevel(amrlev);
+        a_dirty = a_dirty || m_a_coeffs_dirty[amrlev];
+        b_dirty = b_dirty || m_b_coeffs_dirty[amrlev];
+
+        averageDownCoeffsSameAmrLevel(amrlev, m_a_coeffs[amrlev], m_b_coeffs[amrlev],
+                                      a_dirty, b_dirty);
+        if (amrlev > 0) {
+            averageDownCoeffsToCoarseAmrLevel(amrlev,
+                                              a_dirty || m_a_coeffs_dirty[amrlev-1],
+                                              b_dirty || m_b_coeffs_dirty[amrlev-1]);
+        }
     }
 
-    averageDownCoeffsSameAmrLevel(0, m_a_coeffs[0], m_b_coeffs[0]);
+    m_a_coeffs_dirty.assign(m_num_amr_levels, 0);
+    m_b_coeffs_dirty.assign(m_num_amr_levels, 0);
 }
 
 void
 MLABecLaplacian::averageDownCoeffsSameAmrLevel (int amrlev, Vector<MultiFab>& a,
-                                                Vector<Array<MultiFab,AMREX_SPACEDIM> >& b)
+                                                Vector<Array<MultiFab,AMREX_SPACEDIM> >& b,
+                                                bool do_a, bool do_b)
 {
     int nmglevs = a.size();
     for (int mglev = 1; mglev < nmglevs; ++mglev)
     {
         IntVect ratio = (amrlev > 0) ? IntVect(mg_coarsen_ratio) : mg_coarsen_ratio_vec[mglev-1];
 
-        if (m_a_scalar == 0.0)
-        {
-            a[mglev].setVal(0.0);
-        }
-        else
+        if (do_a)
         {
-            amrex::average_down(a[mglev-1], a[mglev], 0, 1, ratio);
+            if (m_a_scalar == 0.0)
+            {
+                a[mglev].setVal(0.0);
+            }
+            else
+            {
+                amrex::average_down(a[mglev-1], a[mglev], 0, 1, ratio);
+            }
         }
 
+        if (!do_b) continue;
+
         Vector<const MultiFab*> fine {AMREX_D_DECL(&(b[mglev-1][0]),
                                                    &(b[mglev-1][1]),
                                                    &(b[mglev-1][2]))};
@@ -204,7 +231,7 @@ MLABecLaplacian::averageDownCoeffsSameAmrLevel (int amrlev, Vector<MultiFab>& a,
         amrex::average_down_faces(fine, crse, ratio, 0);
     }
 
-    for (int mglev = 1; mglev < nmglevs; ++mglev)
+    for (int mglev = 1; mglev < nmglevs && do_b; ++mglev)
     {
         if (m_overset_mask[amrlev][mglev]) {
             const Real fac = static_cast<Real>(1 << mglev); // 2**mglev
@@ -241,33 +268,39 @@ MLABecLaplacian::averageDownCoeffsSameAmrLevel (int amrlev, Vector<MultiFab>& a,
 }
 
 void
-MLABecLaplacian::averageDownCoeffsToCoarseAmrLevel (int flev)
+MLABecLaplacian::averageDownCoeffsToCoarseAmrLevel (int flev, bool do_a, bool do_b)
 {
     auto& fine_a_coeffs = m_a_coeffs[flev  ].back();
     auto& fine_b_coeffs = m_b_coeffs[flev  ].back();
     auto& crse_a_coeffs = m_a_coeffs[flev-1].front();
     auto& crse_b_coeffs = m_b_coeffs[flev-1].front();
 
-    if (m_a_scalar != 0.0) {
+    if (do_a && m_a_scalar != 0.0) {
         // We coarsen from the back of flev to the front of flev-1.
         // So we use mg_coarsen_ratio.
         amrex::average_down(fine_a_coeffs, crse_a_coeffs, 0, 1, mg_coarsen_ratio);
     }
 
-    amrex::average_down_faces(amrex::GetArrOfConstPtrs(fine_b_coeffs),
-                              amrex::GetArrOfPtrs(crse_b_coeffs),
-                              IntVect(mg_coarsen_ratio), m_geom[flev-1][0]);
+    if (do_b) {
+        amrex::average_down_faces(amrex::GetArrOfConstPtrs(fine_b_coeffs),
+                                  amrex::GetArrOfPtrs(crse_b_coeffs),
+                                  IntVect(mg_coarsen_ratio), m_geom[flev-1][0]);
+    }
 }
 
 void
 MLABecLaplacian::applyMetricTermsCoeffs ()
 {
 #if (AMREX_SPACEDIM != 3)
+    // Only to the coefficients that have been set since the last update, because
+    // the metric terms have already been applied to the others.
     for (int alev = 0; alev < m_num_amr_levels; ++alev)
     {
         const int mglev = 0;
-        applyMetricTerm(alev, mglev, m_a_coeffs[alev][mglev]);
-        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        if (m_a_coeffs_dirty[alev]) {
+            applyMetricTerm(alev, mglev, m_a_coeffs[alev][mglev]);
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM && m_b_coeffs_dirty[alev]; ++idim)
         {
             applyMetricTerm(alev, mglev, m_b_coeffs[alev][mglev][idim]);
         }
@@ -439,6 +472,8 @@ MLABecLaplacian::prepareForSolve ()
         }
     }
 
+    makeHaloCoeffs();
+
     m_needs_update = false;
 }
 
@@ -776,6 +811,106 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
     }
 }
 
+bool
+MLABecLaplacian::supportHaloSmoothing () const
+{
+    for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev) {
+        if (m_overset_mask[amrlev][0]) return false;
+    }
+    for (auto const& r : mg_coarsen_ratio_vec) {
+        if (r != mg_coarsen_ratio) return false;
+    }
+    return !hasHiddenDimension();
+}
+
+void
+MLABecLaplacian::makeHaloCoeffs ()
+{
+    const int depth = smootherHaloDepth();
+    if (depth < 2) {
+        m_halo_a_coeffs.clear();
+        m_halo_b_coeffs.clear();
+        return;
+    }
+
+    const int ncomp = getNComp();
+    m_halo_a_coeffs.resize(m_num_amr_levels);
+    m_halo_b_coeffs.resize(m_num_amr_levels);
+    for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
+    {
+        m_halo_a_coeffs[amrlev].resize(m_num_mg_levels[amrlev]);
+        m_halo_b_coeffs[amrlev].resize(m_num_mg_levels[amrlev]);
+        for (int mglev = 0; mglev < m_num_mg_levels[amrlev]; ++mglev)
+        {
+            const auto& period = m_geom[amrlev][mglev].periodicity();
+            const BoxArray& ba = m_grids[amrlev][mglev];
+            const DistributionMapping& dm = m_dmap[amrlev][mglev];
+
+            auto& a = m_halo_a_coeffs[amrlev][mglev];
+            a.define(ba, dm, 1, depth, MFInfo(), *m_factory[amrlev][mglev]);
+            a.setVal(0.0);
+            MultiFab::Copy(a, m_a_coeffs[amrlev][mglev], 0, 0, 1, 0);
+            a.FillBoundary(period);
+
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+            {
+                auto& b = m_halo_b_coeffs[amrlev][mglev][idim];
+                b.define(amrex::convert(ba, IntVect::TheDimensionVector(idim)), dm, ncomp, depth,
+                         MFInfo(), *m_factory[amrlev][mglev]);
+                b.setVal(0.0);
+                MultiFab::Copy(b, m_b_coeffs[amrlev][mglev][idim], 0, 0, ncomp, 0);
+                b.FillBoundary(period);
+            }
+        }
+    }
+}
+
+void
+MLABecLaplacian::FsmoothHalo (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                              const iMultiFab& cover, int redblack, int width) const
+{
+    BL_PROFILE("MLABecLaplacian::FsmoothHalo()");
+
+    const MultiFab& acoef = m_halo_a_coeffs[amrlev][mglev];
+    AMREX_D_TERM(const MultiFab& bxcoef = m_halo_b_coeffs[amrlev][mglev][0];,
+                 const MultiFab& bycoef = m_halo_b_coeffs[amrlev][mglev][1];,
+                 const MultiFab& bzcoef = m_halo_b_coeffs[amrlev][mglev][2];);
+    AMREX_ASSERT(acoef.nGrow() >= width);
+
+    const int nc = getNComp();
+    const Real* h = m_geom[amrlev][mglev].CellSize();
+    AMREX_D_TERM(const Real dhx = m_b_scalar/(h[0]*h[0]);,
+                 const Real dhy = m_b_scalar/(h[1]*h[1]);,
+                 const Real dhz = m_b_scalar/(h[2]*h[2]));
+    const Real alpha = m_a_scalar;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(sol); mfi.isValid(); ++mfi)
+    {
+        const Box& vbx = mfi.validbox();
+        const auto& solnfab = sol.array(mfi);
+        const auto& rhsfab  = rhs.const_array(mfi);
+        const auto& cfab    = cover.const_array(mfi);
+        const auto& afab    = acoef.const_array(mfi);
+        AMREX_D_TERM(const auto& bxfab = bxcoef.const_array(mfi);,
+                     const auto& byfab = bycoef.const_array(mfi);,
+                     const auto& bzfab = bzcoef.const_array(mfi););
+
+        for (const Box& bx : amrex::boxDiff(amrex::grow(vbx,width), vbx))
+        {
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D(bx, nc, i, j, k, n,
+            {
+                abec_gsrb_halo(i,j,k,n, solnfab, rhsfab, alpha, afab,
+                               AMREX_D_DECL(dhx, dhy, dhz),
+                               AMREX_D_DECL(bxfab, byfab, bzfab),
+                               cfab, redblack);
+            });
+        }
+    }
+}
+
 void
 MLABecLaplacian::FFlux (int amrlev, const MFIter& mfi,
                         const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
@@ -899,6 +1034,8 @@ MLABecLaplacian::update ()
         }
     }
 
+    makeHaloCoeffs();
+
     m_needs_update = false;
 }
 
@@ -0,0 +1,898 @@
+
+#include <AMReX_MLAMGSolver.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_iMultiFab.H>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace amrex {
+
+namespace {
+
+using Matrix = MLAMGSolver::Matrix;
+
+// y = A x
+void spmv (Matrix const& A, Vector<Real> const& x, Vector<Real>& y)
+{
+    const int n = A.nrows;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) {
+        Real s = 0.0;
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            s += A.val[e] * x[A.col[e]];
+        }
+        y[i] = s;
+    }
+}
+
+// y += A x
+void spmv_add (Matrix const& A, Vector<Real> const& x, Vector<Real>& y)
+{
+    const int n = A.nrows;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) {
+        Real s = 0.0;
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            s += A.val[e] * x[A.col[e]];
+        }
+        y[i] += s;
+    }
+}
+
+// r = b - A x
+void residual (Matrix const& A, Vector<Real> const& x, Vector<Real> const& b, Vector<Real>& r)
+{
+    const int n = A.nrows;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) {
+        Real s = b[i];
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            s -= A.val[e] * x[A.col[e]];
+        }
+        r[i] = s;
+    }
+}
+
+Real dot (Vector<Real> const& x, Vector<Real> const& y)
+{
+    const int n = x.size();
+    Real s = 0.0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for reduction(+:s)
+#endif
+    for (int i = 0; i < n; ++i) {
+        s += x[i]*y[i];
+    }
+    return s;
+}
+
+Real norm_inf (Vector<Real> const& x)
+{
+    Real s = 0.0;
+    for (Real v : x) {
+        s = std::max(s, std::abs(v));
+    }
+    return s;
+}
+
+// x = a x + b y
+void axpby (Vector<Real>& x, Real a, Real b, Vector<Real> const& y)
+{
+    const int n = x.size();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) {
+        x[i] = a*x[i] + b*y[i];
+    }
+}
+
+Matrix transpose (Matrix const& A)
+{
+    Matrix T;
+    T.nrows = A.ncols;
+    T.ncols = A.nrows;
+    T.rowptr.assign(T.nrows+1, 0);
+    for (int c : A.col) {
+        ++T.rowptr[c+1];
+    }
+    for (int i = 0; i < T.nrows; ++i) {
+        T.rowptr[i+1] += T.rowptr[i];
+    }
+    T.col.resize(A.col.size());
+    T.val.resize(A.val.size());
+    Vector<int> pos(T.rowptr.begin(), T.rowptr.end()-1);
+    for (int i = 0; i < A.nrows; ++i) {
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            const int p = pos[A.col[e]]++;
+            T.col[p] = i;
+            T.val[p] = A.val[e];
+        }
+    }
+    return T;
+}
+
+// C = A B
+Matrix matmul (Matrix const& A, Matrix const& B)
+{
+    Matrix C;
+    C.nrows = A.nrows;
+    C.ncols = B.ncols;
+    C.rowptr.assign(C.nrows+1, 0);
+    Vector<int> marker(B.ncols, -1);
+    Vector<Real> acc(B.ncols, 0.0);
+    Vector<int> cols;
+    for (int i = 0; i < A.nrows; ++i) {
+        cols.clear();
+        for (int ea = A.rowptr[i]; ea < A.rowptr[i+1]; ++ea) {
+            const int k = A.col[ea];
+            const Real a = A.val[ea];
+            for (int eb = B.rowptr[k]; eb < B.rowptr[k+1]; ++eb) {
+                const int j = B.col[eb];
+                if (marker[j] != i) {
+                    marker[j] = i;
+                    acc[j] = 0.0;
+                    cols.push_back(j);
+                }
+                acc[j] += a * B.val[eb];
+            }
+        }
+        std::sort(cols.begin(), cols.end());
+        for (int j : cols) {
+            if (acc[j] != 0.0) {
+                C.col.push_back(j);
+                C.val.push_back(acc[j]);
+            }
+        }
+        C.rowptr[i+1] = static_cast<int>(C.col.size());
+    }
+    return C;
+}
+
+Vector<Real> diagonal (Matrix const& A)
+{
+    Vector<Real> d(A.nrows, 0.0);
+    for (int i = 0; i < A.nrows; ++i) {
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            if (A.col[e] == i) d[i] = A.val[e];
+        }
+    }
+    return d;
+}
+
+/**
+ * Greedy aggregation of Vanek, Mandel and Brezina.  Returns the number of aggregates.
+ * agg[i] is the aggregate of row i, or -1 if row i has no strong connections.
+ */
+int aggregate (Matrix const& A, Vector<Real> const& d, Real theta, Vector<int>& agg)
+{
+    const int n = A.nrows;
+    const Real theta2 = theta*theta;
+    auto strong = [&] (int i, int e) -> bool {
+        const int j = A.col[e];
+        return j != i && A.val[e]*A.val[e] >= theta2*std::abs(d[i]*d[j]);
+    };
+
+    constexpr int unassigned = -2;
+    agg.assign(n, unassigned);
+    int nagg = 0;
+
+    // isolated rows stay out of the aggregates
+    for (int i = 0; i < n; ++i) {
+        bool isolated = true;
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1] && isolated; ++e) {
+            if (strong(i,e)) isolated = false;
+        }
+        if (isolated) agg[i] = -1;
+    }
+
+    // 1. a row and its strong neighbors, if none of them are aggregated yet
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != unassigned) continue;
+        bool free_nbhd = true;
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1] && free_nbhd; ++e) {
+            if (strong(i,e) && agg[A.col[e]] != unassigned) free_nbhd = false;
+        }
+        if (free_nbhd) {
+            agg[i] = nagg;
+            for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+                if (strong(i,e)) agg[A.col[e]] = nagg;
+            }
+            ++nagg;
+        }
+    }
+
+    // 2. join the aggregate of the strongest aggregated neighbor
+    Vector<int> agg1 = agg;
+    for (int i = 0; i < n; ++i) {
+        if (agg1[i] != unassigned) continue;
+        Real amax = -1.0;
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            if (strong(i,e) && agg1[A.col[e]] >= 0 && std::abs(A.val[e]) > amax) {
+                amax = std::abs(A.val[e]);
+                agg[i] = agg1[A.col[e]];
+            }
+        }
+    }
+
+    // 3. the rest form aggregates with their remaining strong neighbors
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != unassigned) continue;
+        agg[i] = nagg;
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            if (strong(i,e) && agg[A.col[e]] == unassigned) agg[A.col[e]] = nagg;
+        }
+        ++nagg;
+    }
+
+    return nagg;
+}
+
+/**
+ * Smoothed prolongation P = (I - omega D_F^{-1} A_F) P_0, where P_0 is the piecewise
+ * constant interpolation from the aggregates, A_F is A with the weak connections lumped
+ * into the diagonal, and omega = 4/(3 rho(D_F^{-1} A_F)).
+ */
+Matrix smoothedProlongation (Matrix const& A, Vector<Real> const& d, Real theta,
+                             Vector<int> const& agg, int nagg)
+{
+    const int n = A.nrows;
+    const Real theta2 = theta*theta;
+    auto strong = [&] (int i, int e) -> bool {
+        const int j = A.col[e];
+        return j != i && A.val[e]*A.val[e] >= theta2*std::abs(d[i]*d[j]);
+    };
+
+    Vector<Real> dF(n);
+    Real rho = 0.0;
+    for (int i = 0; i < n; ++i) {
+        Real di = d[i];
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            if (A.col[e] != i && !strong(i,e)) di += A.val[e];
+        }
+        if (std::abs(di) <= std::numeric_limits<Real>::epsilon()*std::abs(d[i])) di = d[i];
+        dF[i] = di;
+        if (di != 0.0) {
+            Real s = std::abs(di);
+            for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+                if (strong(i,e)) s += std::abs(A.val[e]);
+            }
+            rho = std::max(rho, s/std::abs(di));
+        }
+    }
+    const Real omega = (rho > 0.0) ? Real(4.0)/(Real(3.0)*rho) : Real(0.0);
+
+    Matrix P;
+    P.nrows = n;
+    P.ncols = nagg;
+    P.rowptr.assign(n+1, 0);
+    Vector<int> marker(nagg, -1);
+    Vector<Real> acc(nagg, 0.0);
+    Vector<int> cols;
+    for (int i = 0; i < n; ++i) {
+        cols.clear();
+        auto add = [&] (int c, Real v) {
+            if (marker[c] != i) {
+                marker[c] = i;
+                acc[c] = 0.0;
+                cols.push_back(c);
+            }
+            acc[c] += v;
+        };
+        if (agg[i] >= 0) add(agg[i], 1.0);
+        if (dF[i] != 0.0) {
+            const Real f = omega/dF[i];
+            for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+                const int j = A.col[e];
+                if (j == i) {
+                    if (agg[i] >= 0) add(agg[i], -f*dF[i]);
+                } else if (strong(i,e) && agg[j] >= 0) {
+                    add(agg[j], -f*A.val[e]);
+                }
+            }
+        }
+        std::sort(cols.begin(), cols.end());
+        for (int c : cols) {
+            if (acc[c] != 0.0) {
+                P.col.push_back(c);
+                P.val.push_back(acc[c]);
+            }
+        }
+        P.rowptr[i+1] = static_cast<int>(P.col.size());
+    }
+    return P;
+}
+
+}
+
+MLAMGSolver::MLAMGSolver (MLLinOp& a_lp)
+    : Lp(a_lp),
+      amrlev(0),
+      mglev(a_lp.NMGLevels(0)-1)
+{}
+
+MLAMGSolver::~MLAMGSolver ()
+{}
+
+void
+MLAMGSolver::setup ()
+{
+    BL_PROFILE("MLAMGSolver::setup()");
+
+    m_levels.clear();
+    m_levels.emplace_back();
+    m_levels[0].A = assemble(Lp, m_box_offset);
+    m_ncells = m_box_offset.back();
+
+    while (true)
+    {
+        Level& L = m_levels.back();
+        const int nrows = L.A.nrows;
+        const Vector<Real> d = diagonal(L.A);
+        setDiagonal(L, d);
+
+        if (nrows <= max_coarse_size || getNumLevels() >= max_levels) break;
+
+        Vector<int> agg;
+        const int nagg = aggregate(L.A, d, strong_threshold, agg);
+        if (nagg == 0 || 10*Long(nagg) > 9*Long(nrows)) break;
+
+        Matrix P = smoothedProlongation(L.A, d, strong_threshold, agg, nagg);
+        Matrix R = transpose(P);
+        Matrix Ac = matmul(R, matmul(L.A, P));
+        L.P = std::move(P);
+        L.R = std::move(R);
+
+        Level coarse;
+        coarse.A = std::move(Ac);
+        m_levels.push_back(std::move(coarse));
+    }
+
+    factorCoarsest();
+
+    if (verbose > 0) {
+        amrex::Print() << "MLAMGSolver: " << getNumLevels() << " levels,";
+        for (auto const& L : m_levels) {
+            amrex::Print() << " " << L.A.nrows;
+        }
+        amrex::Print() << " rows\n";
+    }
+}
+
+void
+MLAMGSolver::updateMatrix ()
+{
+    BL_PROFILE("MLAMGSolver::updateMatrix()");
+
+    if (m_levels.empty()) {
+        setup();
+        return;
+    }
+
+    Level& L = m_levels[0];
+    L.A = assemble(Lp, m_box_offset);
+    setDiagonal(L, diagonal(L.A));
+    if (getNumLevels() == 1) {
+        factorCoarsest();
+    }
+}
+
+void
+MLAMGSolver::setDiagonal (Level& L, Vector<Real> const& d)
+{
+    const int nrows = L.A.nrows;
+    L.dinv.resize(nrows);
+    for (int i = 0; i < nrows; ++i) {
+        L.dinv[i] = (d[i] != 0.0) ? Real(1.0)/d[i] : Real(0.0);
+    }
+    L.x.assign(nrows, 0.0);
+    L.b.assign(nrows, 0.0);
+    L.r.assign(nrows, 0.0);
+}
+
+MLAMGSolver::Matrix
+MLAMGSolver::assemble (MLLinOp& Lp, Vector<Long>& box_offset, int root)
+{
+    BL_PROFILE("MLAMGSolver::assemble()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(Lp.getNComp() == 1 && Lp.isCellCentered(),
+                                     "MLAMGSolver: only single-component cell-centered operators are supported");
+
+    const int amrlev = 0;
+    const int mglev = Lp.NMGLevels(0)-1;
+    const Geometry& geom = Lp.m_geom[amrlev][mglev];
+    const BoxArray& ba = Lp.m_grids[amrlev][mglev];
+    const DistributionMapping& dm = Lp.m_dmap[amrlev][mglev];
+    const Box& domain = geom.Domain();
+    const auto dlo = amrex::lbound(domain);
+
+    const int nboxes = ba.size();
+    box_offset.resize(nboxes+1);
+    Long ncells = 0;
+    for (int ibox = 0; ibox < nboxes; ++ibox) {
+        box_offset[ibox] = ncells;
+        ncells += ba[ibox].numPts();
+    }
+    box_offset[nboxes] = ncells;
+
+    constexpr int nst = AMREX_D_TERM(3,*3,*3);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncells*nst < Long(INT_MAX),
+                                     "MLAMGSolver: bottom level too big");
+    const int n = static_cast<int>(ncells);
+
+    // The probing vector of color c is one in the cells of color c.  The period of the
+    // colors is 3 in each direction, or a divisor of the domain length in periodic
+    // directions, so no two cells of the same color are within one cell of each other.
+    IntVect period(3);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (geom.isPeriodic(idim)) {
+            const int len = domain.length(idim);
+            period[idim] = len;
+            for (int p = 3; p < len; ++p) {
+                if (len % p == 0) {
+                    period[idim] = p;
+                    break;
+                }
+            }
+        }
+    }
+    const int ncolors = AMREX_D_TERM(period[0],*period[1],*period[2]);
+    auto color = [&] (int i, int j, int k) -> int {
+        amrex::ignore_unused(j,k);
+        return AMREX_D_TERM(  ((i-dlo.x) % period[0] + period[0]) % period[0],
+                            + ((j-dlo.y) % period[1] + period[1]) % period[1] * period[0],
+                            + ((k-dlo.z) % period[2] + period[2]) % period[2] * period[0]*period[1]);
+    };
+
+    // global cell index, with a ghost cell that is -1 outside the level
+    iMultiFab gid(ba, dm, 1, 1, MFInfo().SetArena(The_Pinned_Arena()));
+    gid.setVal(-1);
+    for (MFIter mfi(gid); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const auto lo = amrex::lbound(bx);
+        const auto len = amrex::length(bx);
+        const int offset = static_cast<int>(box_offset[mfi.index()]);
+        const auto& g = gid.array(mfi);
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            g(i,j,k) = offset + (i-lo.x) + ((j-lo.y) + (k-lo.z)*len.y)*len.x;
+        });
+    }
+    gid.FillBoundary(geom.periodicity());
+
+    // Entry s of row i is A(i,j) of the neighbor j = i + (s%3-1, (s/3)%3-1, s/9-1).
+    // Zero entries are padding, and the column is stored plus one, so that the rows of
+    // all ranks can be summed.
+    Vector<Real> vals(std::size_t(n)*nst, 0.0);
+    Vector<int> cols(std::size_t(n)*nst, 0);
+    {
+        auto const& factory = *Lp.Factory(amrlev, mglev);
+        MultiFab in(ba, dm, 1, 1, MFInfo(), factory);
+        MultiFab out(ba, dm, 1, 0, MFInfo(), factory);
+        MultiFab hin(ba, dm, 1, 0, MFInfo().SetArena(The_Pinned_Arena()));
+        MultiFab hout(ba, dm, 1, 0, MFInfo().SetArena(The_Pinned_Arena()));
+
+        for (int c = 0; c < ncolors; ++c)
+        {
+            for (MFIter mfi(hin); mfi.isValid(); ++mfi) {
+                const auto& a = hin.array(mfi);
+                amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+                {
+                    a(i,j,k) = (color(i,j,k) == c) ? Real(1.0) : Real(0.0);
+                });
+            }
+            in.setVal(0.0);
+            MultiFab::Copy(in, hin, 0, 0, 1, 0);
+            Lp.apply(amrlev, mglev, out, in, MLLinOp::BCMode::Homogeneous,
+                     MLLinOp::StateMode::Correction);
+            MultiFab::Copy(hout, out, 0, 0, 1, 0);
+            Gpu::streamSynchronize();
+
+            for (MFIter mfi(hout); mfi.isValid(); ++mfi) {
+                const auto& a = hout.const_array(mfi);
+                const auto& g = gid.const_array(mfi);
+                amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+                {
+                    const Real v = a(i,j,k);
+                    if (v == 0.0) return;
+                    const std::size_t row = g(i,j,k);
+                    for (int s = 0; s < nst; ++s) {
+                        const int ii = i + s%3 - 1;
+                        const int jj = (AMREX_SPACEDIM > 1) ? j + (s/3)%3 - 1 : j;
+                        const int kk = (AMREX_SPACEDIM > 2) ? k + s/9 - 1 : k;
+                        const int gj = g(ii,jj,kk);
+                        if (gj >= 0 && color(ii,jj,kk) == c) {
+                            vals[row*nst+s] = v;
+                            cols[row*nst+s] = gj+1;
+                            break;
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+    Matrix A;
+    if (root < 0) {
+        ParallelAllReduce::Sum(vals.data(), static_cast<int>(vals.size()),
+                               Lp.BottomCommunicator());
+        ParallelAllReduce::Sum(cols.data(), static_cast<int>(cols.size()),
+                               Lp.BottomCommunicator());
+    } else {
+        ParallelReduce::Sum(vals.data(), static_cast<int>(vals.size()), root,
+                            Lp.BottomCommunicator());
+        ParallelReduce::Sum(cols.data(), static_cast<int>(cols.size()), root,
+                            Lp.BottomCommunicator());
+        if (ParallelDescriptor::MyProc(Lp.BottomCommunicator()) != root) {
+            return A;
+        }
+    }
+
+    A.nrows = n;
+    A.ncols = n;
+    A.rowptr.assign(n+1, 0);
+    for (int i = 0; i < n; ++i) {
+        bool has_diag = false;
+        for (int s = 0; s < nst; ++s) {
+            const std::size_t e = std::size_t(i)*nst + s;
+            if (vals[e] != 0.0) {
+                A.col.push_back(cols[e]-1);
+                A.val.push_back(vals[e]);
+                has_diag = has_diag || (cols[e]-1 == i);
+            }
+        }
+        if (!has_diag && A.rowptr[i] == static_cast<int>(A.col.size())) {
+            A.col.push_back(i);  // empty rows, e.g., of covered cells
+            A.val.push_back(1.0);
+        }
+        A.rowptr[i+1] = static_cast<int>(A.col.size());
+    }
+    return A;
+}
+
+void
+MLAMGSolver::factorCoarsest ()
+{
+    m_lu.clear();
+    m_lu_piv.clear();
+
+    constexpr int max_dense_size = 2000;
+    Matrix const& A = m_levels.back().A;
+    const int n = A.nrows;
+    if (n > max_dense_size) return; // solveCoarsest smoothes instead
+
+    m_lu.assign(std::size_t(n)*n, 0.0);
+    m_lu_piv.resize(n);
+    Real amax = 0.0;
+    for (int i = 0; i < n; ++i) {
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            m_lu[std::size_t(i)*n+A.col[e]] += A.val[e];
+            amax = std::max(amax, std::abs(A.val[e]));
+        }
+    }
+
+    // LU with partial pivoting.  Zero pivots, e.g., of singular problems with pure
+    // Neumann or periodic boundaries, are left as zero and skipped by solveCoarsest.
+    const Real tiny = amax * Real(1.e-12);
+    for (int k = 0; k < n; ++k) {
+        int p = k;
+        for (int i = k+1; i < n; ++i) {
+            if (std::abs(m_lu[std::size_t(i)*n+k]) > std::abs(m_lu[std::size_t(p)*n+k])) p = i;
+        }
+        m_lu_piv[k] = p;
+        if (p != k) {
+            for (int j = 0; j < n; ++j) {
+                std::swap(m_lu[std::size_t(k)*n+j], m_lu[std::size_t(p)*n+j]);
+            }
+        }
+        const Real piv = m_lu[std::size_t(k)*n+k];
+        if (std::abs(piv) <= tiny) {
+            m_lu[std::size_t(k)*n+k] = 0.0;
+            continue;
+        }
+        for (int i = k+1; i < n; ++i) {
+            const Real f = m_lu[std::size_t(i)*n+k] / piv;
+            m_lu[std::size_t(i)*n+k] = f;
+            if (f != 0.0) {
+                for (int j = k+1; j < n; ++j) {
+                    m_lu[std::size_t(i)*n+j] -= f * m_lu[std::size_t(k)*n+j];
+                }
+            }
+        }
+    }
+}
+
+void
+MLAMGSolver::solveCoarsest (Vector<Real>& x, Vector<Real> const& b) const
+{
+    const int n = static_cast<int>(b.size());
+    x = b;
+    for (int k = 0; k < n; ++k) {
+        std::swap(x[k], x[m_lu_piv[k]]);
+    }
+    for (int i = 0; i < n; ++i) {
+        Real s = x[i];
+        for (int j = 0; j < i; ++j) {
+            s -= m_lu[std::size_t(i)*n+j] * x[j];
+        }
+        x[i] = s;
+    }
+    for (int i = n-1; i >= 0; --i) {
+        const Real piv = m_lu[std::size_t(i)*n+i];
+        if (piv == 0.0) {
+            x[i] = 0.0;
+        } else {
+            Real s = x[i];
+            for (int j = i+1; j < n; ++j) {
+                s -= m_lu[std::size_t(i)*n+j] * x[j];
+            }
+            x[i] = s / piv;
+        }
+    }
+}
+
+// Gauss-Seidel within the rows of each thread, Jacobi across threads
+void
+MLAMGSolver::smooth (Level& L, bool forward)
+{
+    Matrix const& A = L.A;
+    const int n = A.nrows;
+    Vector<Real>& x = L.x;
+    Vector<Real> const& b = L.b;
+    const bool threaded = OpenMP::get_max_threads() > 1;
+    if (threaded) {
+        L.xold = x;
+    }
+    Vector<Real> const& xold = L.xold;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+    {
+        const int nthreads = OpenMP::get_num_threads();
+        const int tid = OpenMP::get_thread_num();
+        const int lo = static_cast<int>((Long(n)*tid)/nthreads);
+        const int hi = static_cast<int>((Long(n)*(tid+1))/nthreads);
+        for (int m = 0; m < hi-lo; ++m) {
+            const int i = forward ? lo+m : hi-1-m;
+            Real s = b[i];
+            for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+                const int j = A.col[e];
+                if (j != i) {
+                    s -= A.val[e] * ((!threaded || (j >= lo && j < hi)) ? x[j] : xold[j]);
+                }
+            }
+            if (L.dinv[i] != 0.0) {
+                x[i] = s * L.dinv[i];
+            }
+        }
+    }
+}
+
+void
+MLAMGSolver::vcycle (int lev)
+{
+    Level& L = m_levels[lev];
+    if (lev == getNumLevels()-1)
+    {
+        if (!m_lu_piv.empty()) {
+            solveCoarsest(L.x, L.b);
+        } else {
+            std::fill(L.x.begin(), L.x.end(), 0.0);
+            for (int i = 0; i < 10; ++i) {
+                smooth(L, true);
+                smooth(L, false);
+            }
+        }
+        return;
+    }
+
+    std::fill(L.x.begin(), L.x.end(), 0.0);
+    smooth(L, true);
+    residual(L.A, L.x, L.b, L.r);
+    Level& C = m_levels[lev+1];
+    spmv(L.R, L.r, C.b);
+    vcycle(lev+1);
+    spmv_add(L.P, C.x, L.x);
+    smooth(L, false);
+}
+
+void
+MLAMGSolver::applyPrecond (Vector<Real>& z, Vector<Real> const& r)
+{
+    m_levels[0].b = r;
+    vcycle(0);
+    z = m_levels[0].x;
+}
+
+int
+MLAMGSolver::solve (MultiFab& sol, const MultiFab& rhs, Real eps_rel, Real eps_abs)
+{
+    BL_PROFILE("MLAMGSolver::solve()");
+
+    AMREX_ALWAYS_ASSERT(!m_levels.empty());
+
+    const int n = static_cast<int>(m_ncells);
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    MultiFab hmf(ba, dm, 2, 0, MFInfo().SetArena(The_Pinned_Arena()));
+    MultiFab::Copy(hmf, sol, 0, 0, 1, 0);
+    MultiFab::Copy(hmf, rhs, 0, 1, 1, 0);
+    Gpu::streamSynchronize();
+
+    // gather x and b on all ranks
+    Vector<Real> xb(2*std::size_t(n), 0.0);
+    for (MFIter mfi(hmf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const auto lo = amrex::lbound(bx);
+        const auto len = amrex::length(bx);
+        const Long offset = m_box_offset[mfi.index()];
+        const auto& a = hmf.const_array(mfi);
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            const Long m = offset + (i-lo.x) + ((j-lo.y) + (k-lo.z)*len.y)*len.x;
+            xb[m] = a(i,j,k,0);
+            xb[n+m] = a(i,j,k,1);
+        });
+    }
+    ParallelAllReduce::Sum(xb.data(), static_cast<int>(xb.size()),
+                           Lp.BottomCommunicator());
+    Vector<Real> x(xb.begin(), xb.begin()+n);
+    Vector<Real> b(xb.begin()+n, xb.end());
+    Vector<Real>().swap(xb);
+
+    Matrix const& A = m_levels[0].A;
+    Vector<Real> r(n), rh(n), p(n, 0.0), v(n, 0.0), ph(n), s(n), sh(n), t(n);
+
+    residual(A, x, b, r);
+    rh = r;
+
+    Real rnorm = norm_inf(r);
+    const Real rnorm0 = rnorm;
+
+    if (verbose > 0) {
+        amrex::Print() << "MLAMGSolver: Initial error (error0) =        " << rnorm0 << '\n';
+    }
+
+    int ret = 0;
+    iter = 1;
+    Real rho_1 = 0, alpha = 0, omega = 0;
+
+    if (rnorm0 == 0 || rnorm0 < eps_abs)
+    {
+        if (verbose > 0) {
+            amrex::Print() << "MLAMGSolver: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    for (; iter <= maxiter; ++iter)
+    {
+        const Real rho = dot(rh, r);
+        if (rho == 0.0)
+        {
+            ret = 1; break;
+        }
+        if (iter == 1)
+        {
+            p = r;
+        }
+        else
+        {
+            const Real beta = (rho/rho_1)*(alpha/omega);
+            axpby(p, 1.0, -omega, v);      // p = p - omega v
+            axpby(p, beta, 1.0, r);        // p = r + beta p
+        }
+        applyPrecond(ph, p);
+        spmv(A, ph, v);
+
+        const Real rhTv = dot(rh, v);
+        if (rhTv != 0.0)
+        {
+            alpha = rho/rhTv;
+        }
+        else
+        {
+            ret = 2; break;
+        }
+        axpby(x, 1.0, alpha, ph);
+        s = r;
+        axpby(s, 1.0, -alpha, v);
+
+        rnorm = norm_inf(s);
+
+        if (verbose > 2)
+        {
+            amrex::Print() << "MLAMGSolver: Half Iter "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if (rnorm < eps_rel*rnorm0 || rnorm < eps_abs) break;
+
+        applyPrecond(sh, s);
+        spmv(A, sh, t);
+
+        const Real tvals0 = dot(t, t);
+        const Real tvals1 = dot(t, s);
+        if (tvals0 != 0.0)
+        {
+            omega = tvals1/tvals0;
+        }
+        else
+        {
+            ret = 3; break;
+        }
+        axpby(x, 1.0, omega, sh);
+        r = s;
+        axpby(r, 1.0, -omega, t);
+
+        rnorm = norm_inf(r);
+
+        if (verbose > 2)
+        {
+            amrex::Print() << "MLAMGSolver: Iteration "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if (rnorm < eps_rel*rnorm0 || rnorm < eps_abs) break;
+
+        if (omega == 0.0)
+        {
+            ret = 4; break;
+        }
+        rho_1 = rho;
+    }
+
+    if (verbose > 0)
+    {
+        amrex::Print() << "MLAMGSolver: Final: Iteration "
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if (ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+    {
+        if (verbose > 0) {
+            amrex::Warning("MLAMGSolver:: failed to converge!");
+        }
+        ret = 8;
+    }
+
+    if ((ret == 0 || ret == 8) && (rnorm < rnorm0))
+    {
+        for (MFIter mfi(hmf); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            const auto lo = amrex::lbound(bx);
+            const auto len = amrex::length(bx);
+            const Long offset = m_box_offset[mfi.index()];
+            const auto& a = hmf.array(mfi);
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+            {
+                a(i,j,k,0) = x[offset + (i-lo.x) + ((j-lo.y) + (k-lo.z)*len.y)*len.x];
+            });
+        }
+        MultiFab::Copy(sol, hmf, 0, 0, 1, 0);
+    }
+
+    return ret;
+}
+
+}
@@ -49,6 +49,84 @@ sxay (MultiFab&       ss,
     sxay(ss,xx,a,yy,0,nghost);
 }
 
+// sxay for the active components only, with a coefficient per component
+void
+sxay_comp (MultiFab&           ss,
+           const MultiFab&     xx,
+           Vector<Real> const& a,
+           const MultiFab&     yy,
+           Vector<int> const&  active,
+           int                 nghost)
+{
+    BL_PROFILE("CGSolver::sxay_comp()");
+
+    for (int n = 0; n < ss.nComp(); ++n) {
+        if (active[n]) {
+            MultiFab::LinComb(ss, 1.0, xx, n, a[n], yy, n, n, 1, nghost);
+        }
+    }
+}
+
+#ifdef BL_USE_MPI
+// Sums all but the last value of a vector of Reals, and takes the max of the last one.
+// The datatype is the whole vector, so MPI cannot split it.
+void
+sum_and_max (void* invec, void* inoutvec, int* len, MPI_Datatype* dtype)
+{
+    int nbytes;
+    MPI_Type_size(*dtype, &nbytes);
+    const int n = nbytes / static_cast<int>(sizeof(Real));
+    const Real* in = static_cast<Real const*>(invec);
+    Real* inout = static_cast<Real*>(inoutvec);
+    for (int l = 0; l < *len; ++l, in += n, inout += n) {
+        for (int i = 0; i < n-1; ++i) {
+            inout[i] += in[i];
+        }
+        inout[n-1] = std::max(inout[n-1], in[n-1]);
+    }
+}
+
+MPI_Op sum_and_max_op = MPI_OP_NULL;
+#endif
+
+/**
+ * Non-blocking all-reduce of n local values: the first n-1 are summed and the last,
+ * a norm, is maxed.  The values must stay alive and untouched until wait() returns.
+ */
+class PipelinedReduce
+{
+public:
+    void start (Real* v, int n, MPI_Comm comm)
+    {
+#ifdef BL_USE_MPI
+        if (sum_and_max_op == MPI_OP_NULL) {
+            MPI_Op_create(&sum_and_max, 1, &sum_and_max_op);
+            amrex::ExecOnFinalize([] () { MPI_Op_free(&sum_and_max_op); });
+        }
+        MPI_Type_contiguous(n, ParallelDescriptor::Mpi_typemap<Real>::type(), &m_type);
+        MPI_Type_commit(&m_type);
+        MPI_Iallreduce(MPI_IN_PLACE, v, 1, m_type, sum_and_max_op, comm, &m_req);
+#else
+        amrex::ignore_unused(v,n,comm);
+#endif
+    }
+
+    void wait ()
+    {
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+#ifdef BL_USE_MPI
+        MPI_Wait(&m_req, MPI_STATUS_IGNORE);
+        MPI_Type_free(&m_type);
+#endif
+    }
+
+private:
+#ifdef BL_USE_MPI
+    MPI_Request m_req = MPI_REQUEST_NULL;
+    MPI_Datatype m_type = MPI_DATATYPE_NULL;
+#endif
+};
+
 }
 
 MLCGSolver::MLCGSolver (MLMG* a_mlmg, MLLinOp& _lp, Type _typ)
@@ -71,8 +149,17 @@ MLCGSolver::solve (MultiFab&       sol,
                    Real            eps_rel,
                    Real            eps_abs)
 {
-    if (solver_type == Type::BiCGStab) {
+    const bool comp = independent_comps && sol.nComp() > 1 && Lp.isCellCentered();
+    if (comp && solver_type == Type::BiCGStab) {
+        return solve_bicgstab_comp(sol,rhs,eps_rel,eps_abs);
+    } else if (comp && solver_type == Type::CG) {
+        return solve_cg_comp(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::BiCGStab) {
         return solve_bicgstab(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::PipelinedBiCGStab) {
+        return solve_pipelined_bicgstab(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::PipelinedCG) {
+        return solve_pipelined_cg(sol,rhs,eps_rel,eps_abs);
     } else {
         return solve_cg(sol,rhs,eps_rel,eps_abs);
     }
@@ -396,6 +483,718 @@ MLCGSolver::solve_cg (MultiFab&       sol,
     return ret;
 }
 
+int
+MLCGSolver::solve_bicgstab_comp (MultiFab&       sol,
+                                 const MultiFab& rhs,
+                                 Real            eps_rel,
+                                 Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::bicgstab_comp");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    MultiFab ph(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    MultiFab sh(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    ph.setVal(0.0);
+    sh.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab r    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rh   (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab v    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab t    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+    Lp.normalize(amrlev, mglev, r);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+
+    sol.setVal(0);
+
+    Vector<Real> rnorm0(ncomp);
+    norm_inf_comp(r, rnorm0);
+    Vector<Real> rnorm = rnorm0;
+
+    // A component drops out once it has converged.
+    Vector<int> active(ncomp);
+    auto update_active = [&] () -> int {
+        int nactive = 0;
+        for (int n = 0; n < ncomp; ++n) {
+            if (rnorm[n] == 0 || rnorm[n] < eps_rel*rnorm0[n] || rnorm[n] < eps_abs) {
+                active[n] = 0;
+            }
+            nactive += active[n];
+        }
+        return nactive;
+    };
+    auto max_rel_err = [&] () -> Real {
+        Real e = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            if (rnorm0[n] > 0) e = std::max(e, rnorm[n]/rnorm0[n]);
+        }
+        return e;
+    };
+
+    std::fill(active.begin(), active.end(), 1);
+    int nactive = update_active();
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_BiCGStab: Initial error (error0) =        "
+                       << *std::max_element(rnorm0.begin(), rnorm0.end())
+                       << ", " << ncomp << " independent components\n";
+    }
+    int ret = 0;
+    iter = 1;
+    if (nactive == 0) return ret;
+
+    Vector<Real> rho(ncomp), rho_1(ncomp, 0.0), alpha(ncomp, 0.0), omega(ncomp, 0.0);
+    Vector<Real> beta(ncomp), rhTv(ncomp), tvals(2*ncomp), neg(ncomp), tmp(ncomp);
+
+    for (; iter <= maxiter; ++iter)
+    {
+        dotxy_comp(rh, r, rho);
+        for (int n = 0; n < ncomp; ++n) {
+            if (active[n] && rho[n] == 0) ret = 1;
+        }
+        if ( ret != 0 ) break;
+        if ( iter == 1 )
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            for (int n = 0; n < ncomp; ++n) {
+                beta[n] = active[n] ? (rho[n]/rho_1[n])*(alpha[n]/omega[n]) : Real(0.0);
+                neg[n] = -omega[n];
+            }
+            sxay_comp(p, p, neg, v, active, nghost);
+            sxay_comp(p, r, beta, p, active, nghost);
+        }
+        MultiFab::Copy(ph,p,0,0,ncomp,nghost);
+        Lp.apply(amrlev, mglev, v, ph, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, v);
+
+        dotxy_comp(rh, v, rhTv);
+        for (int n = 0; n < ncomp; ++n) {
+            if (!active[n]) continue;
+            if ( rhTv[n] != Real(0.0) ) {
+                alpha[n] = rho[n]/rhTv[n];
+            } else {
+                ret = 2;
+            }
+            neg[n] = -alpha[n];
+        }
+        if ( ret != 0 ) break;
+        sxay_comp(sol, sol, alpha, ph, active, nghost);
+        sxay_comp(s,     r,   neg,  v, active, nghost);
+
+        norm_inf_comp(s, tmp);
+        for (int n = 0; n < ncomp; ++n) {
+            if (active[n]) rnorm[n] = tmp[n];
+        }
+        nactive = update_active();
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_BiCGStab: Half Iter "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << max_rel_err() << ", " << nactive << " active\n";
+        }
+
+        if ( nactive == 0 ) break;
+
+        MultiFab::Copy(sh,s,0,0,ncomp,nghost);
+        Lp.apply(amrlev, mglev, t, sh, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, t);
+
+        // one reduction for the two inner products of all the components
+        dotxy_comp(t, t, tmp, true);
+        std::copy(tmp.begin(), tmp.end(), tvals.begin());
+        dotxy_comp(t, s, tmp, true);
+        std::copy(tmp.begin(), tmp.end(), tvals.begin()+ncomp);
+
+        BL_PROFILE_VAR("MLCGSolver::ParallelAllReduce", blp_par);
+        ParallelAllReduce::Sum(tvals.data(),2*ncomp,Lp.BottomCommunicator());
+        BL_PROFILE_VAR_STOP(blp_par);
+
+        for (int n = 0; n < ncomp; ++n) {
+            if (!active[n]) continue;
+            if ( tvals[n] != Real(0.0) ) {
+                omega[n] = tvals[ncomp+n]/tvals[n];
+            } else {
+                ret = 3;
+            }
+            neg[n] = -omega[n];
+        }
+        if ( ret != 0 ) break;
+        sxay_comp(sol, sol, omega, sh, active, nghost);
+        sxay_comp(r,     s,   neg,  t, active, nghost);
+
+        norm_inf_comp(r, tmp);
+        for (int n = 0; n < ncomp; ++n) {
+            if (active[n]) rnorm[n] = tmp[n];
+        }
+        nactive = update_active();
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_BiCGStab: Iteration "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << max_rel_err() << ", " << nactive << " active\n";
+        }
+
+        if ( nactive == 0 ) break;
+
+        for (int n = 0; n < ncomp; ++n) {
+            if (active[n] && omega[n] == 0) ret = 4;
+        }
+        if ( ret != 0 ) break;
+        rho_1 = rho;
+    }
+
+    return finish_comp(sol, sorig, rnorm, rnorm0, eps_rel, eps_abs, ret, "MLCGSolver_BiCGStab");
+}
+
+int
+MLCGSolver::solve_cg_comp (MultiFab&       sol,
+                           const MultiFab& rhs,
+                           Real            eps_rel,
+                           Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::cg_comp");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    MultiFab p(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    p.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab r    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    sol.setVal(0);
+
+    Vector<Real> rnorm0(ncomp);
+    norm_inf_comp(r, rnorm0);
+    Vector<Real> rnorm = rnorm0;
+
+    // A component drops out once it has converged.
+    Vector<int> active(ncomp, 1);
+    auto update_active = [&] () -> int {
+        int nactive = 0;
+        for (int n = 0; n < ncomp; ++n) {
+            if (rnorm[n] == 0 || rnorm[n] < eps_rel*rnorm0[n] || rnorm[n] < eps_abs) {
+                active[n] = 0;
+            }
+            nactive += active[n];
+        }
+        return nactive;
+    };
+    int nactive = update_active();
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_CG: Initial error (error0) :        "
+                       << *std::max_element(rnorm0.begin(), rnorm0.end())
+                       << ", " << ncomp << " independent components\n";
+    }
+
+    int  ret = 0;
+    iter = 1;
+    if (nactive == 0) return ret;
+
+    Vector<Real> rho(ncomp), rho_1(ncomp, 0.0), alpha(ncomp, 0.0), beta(ncomp);
+    Vector<Real> pw(ncomp), neg(ncomp), tmp(ncomp);
+
+    for (; iter <= maxiter; ++iter)
+    {
+        dotxy_comp(r, r, rho);
+        for (int n = 0; n < ncomp; ++n) {
+            if (active[n] && rho[n] == 0) ret = 1;
+        }
+        if ( ret != 0 ) break;
+        if (iter == 1)
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            for (int n = 0; n < ncomp; ++n) {
+                beta[n] = active[n] ? rho[n]/rho_1[n] : Real(0.0);
+            }
+            sxay_comp(p, r, beta, p, active, nghost);
+        }
+        Lp.apply(amrlev, mglev, q, p, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+        dotxy_comp(p, q, pw);
+        for (int n = 0; n < ncomp; ++n) {
+            if (!active[n]) continue;
+            if ( pw[n] != Real(0.0) ) {
+                alpha[n] = rho[n]/pw[n];
+            } else {
+                ret = 1;
+            }
+            neg[n] = -alpha[n];
+        }
+        if ( ret != 0 ) break;
+
+        sxay_comp(sol, sol, alpha, p, active, nghost);
+        sxay_comp(  r,   r,   neg, q, active, nghost);
+
+        norm_inf_comp(r, tmp);
+        for (int n = 0; n < ncomp; ++n) {
+            if (active[n]) rnorm[n] = tmp[n];
+        }
+        nactive = update_active();
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_cg:       Iteration"
+                           << std::setw(4) << iter
+                           << ", " << nactive << " active\n";
+        }
+
+        if ( nactive == 0 ) break;
+
+        rho_1 = rho;
+    }
+
+    return finish_comp(sol, sorig, rnorm, rnorm0, eps_rel, eps_abs, ret, "MLCGSolver_cg");
+}
+
+int
+MLCGSolver::finish_comp (MultiFab& sol, const MultiFab& sorig,
+                         Vector<Real> const& rnorm, Vector<Real> const& rnorm0,
+                         Real eps_rel, Real eps_abs, int ret, const char* name)
+{
+    const int ncomp = sol.nComp();
+
+    Real max_rel_err = 0.0;
+    bool converged = true;
+    for (int n = 0; n < ncomp; ++n) {
+        if (rnorm0[n] > 0) max_rel_err = std::max(max_rel_err, rnorm[n]/rnorm0[n]);
+        if (rnorm[n] > eps_rel*rnorm0[n] && rnorm[n] > eps_abs) converged = false;
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << name << ": Final Iteration"
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << max_rel_err << '\n';
+    }
+
+    if ( ret == 0 && !converged )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning(std::string(name) + ": failed to converge!");
+        ret = 8;
+    }
+
+    // keep the correction of the components it has improved
+    for (int n = 0; n < ncomp; ++n) {
+        if ( !( ( ret == 0 || ret == 8 ) && (rnorm[n] < rnorm0[n]) ) ) {
+            sol.setVal(0.0, n, 1, nghost);
+        }
+    }
+    sol.plus(sorig, 0, ncomp, nghost);
+
+    return ret;
+}
+
+int
+MLCGSolver::solve_pipelined_bicgstab (MultiFab&       sol,
+                                      const MultiFab& rhs,
+                                      Real            eps_rel,
+                                      Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipelined_bicgstab");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // w and z are operator inputs and need the ghost cells of sol
+    MultiFab w(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    MultiFab z(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    w.setVal(0.0);
+    z.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab r    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rh   (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab y    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab t    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab v    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+    Lp.normalize(amrlev, mglev, r);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+
+    sol.setVal(0);
+
+    PipelinedReduce reduce;
+
+    // w = A r and t = A w, with (rh,r), (rh,w) and |r| reduced behind the second apply
+    MultiFab::Copy(w,r,0,0,ncomp,nghost);
+    Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, t);
+    MultiFab::Copy(w,t,0,0,ncomp,nghost);
+
+    Real red0[3] = { dotxy(rh,r,true), dotxy(rh,w,true), norm_inf(r,true) };
+    reduce.start(red0, 3, Lp.BottomCommunicator());
+    Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, t);
+    reduce.wait();
+
+    Real rnorm = red0[2];
+    const Real rnorm0 = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Initial error (error0) =        " << rnorm0 << '\n';
+    }
+    int ret = 0;
+    iter = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedBiCGStab: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    Real rho = red0[0];
+    if ( rho == 0 || red0[1] == 0 )
+    {
+        ret = 1;
+    }
+    Real alpha = (ret == 0) ? rho/red0[1] : Real(0.0);
+    Real beta = 0, omega = 0;
+
+    for (; ret == 0 && iter <= maxiter; ++iter)
+    {
+        if ( iter == 1 )
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(z,t,0,0,ncomp,nghost);
+        }
+        else
+        {
+            // p = r + beta*(p - omega*s), s = w + beta*(s - omega*z), z = t + beta*(z - omega*v)
+            sxay(p, p, -omega, s, nghost);
+            sxay(p, r,   beta, p, nghost);
+            sxay(s, s, -omega, z, nghost);
+            sxay(s, w,   beta, s, nghost);
+            sxay(z, z, -omega, v, nghost);
+            sxay(z, t,   beta, z, nghost);
+        }
+        sxay(q, r, -alpha, s, nghost);
+        sxay(y, w, -alpha, z, nghost);
+
+        Real red1[3] = { dotxy(q,y,true), dotxy(y,y,true), norm_inf(q,true) };
+        reduce.start(red1, 3, Lp.BottomCommunicator());
+        Lp.apply(amrlev, mglev, v, z, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, v);
+        reduce.wait();
+
+        rnorm = red1[2];
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Half Iter "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs )
+        {
+            sxay(sol, sol, alpha, p, nghost);
+            break;
+        }
+
+        if ( red1[1] != Real(0.0) )
+        {
+            omega = red1[0]/red1[1];
+        }
+        else
+        {
+            ret = 3; break;
+        }
+        if ( omega == 0 )
+        {
+            ret = 4; break;
+        }
+
+        // x += alpha*p + omega*q, r = q - omega*y, w = y - omega*(t - alpha*v)
+        sxay(sol, sol, alpha, p, nghost);
+        sxay(sol, sol, omega, q, nghost);
+        sxay(r, q, -omega, y, nghost);
+        sxay(t, t, -alpha, v, nghost);
+        sxay(w, y, -omega, t, nghost);
+
+        Real red2[5] = { dotxy(rh,r,true), dotxy(rh,w,true), dotxy(rh,s,true), dotxy(rh,z,true),
+                         norm_inf(r,true) };
+        reduce.start(red2, 5, Lp.BottomCommunicator());
+        Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, t);
+        reduce.wait();
+
+        rnorm = red2[4];
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Iteration "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        const Real rho_1 = rho;
+        rho = red2[0];
+        if ( rho == 0 )
+        {
+            ret = 1; break;
+        }
+        beta = (rho/rho_1)*(alpha/omega);
+        const Real denom = red2[1] + beta*red2[2] - beta*omega*red2[3];
+        if ( denom != Real(0.0) )
+        {
+            alpha = rho/denom;
+        }
+        else
+        {
+            ret = 2; break;
+        }
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Final: Iteration "
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipelinedBiCGStab:: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+int
+MLCGSolver::solve_pipelined_cg (MultiFab&       sol,
+                                const MultiFab& rhs,
+                                Real            eps_rel,
+                                Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipelined_cg");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // w is an operator input and needs the ghost cells of sol
+    MultiFab w(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    w.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab r    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab z    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    sol.setVal(0);
+
+    // w = A r
+    MultiFab::Copy(w,r,0,0,ncomp,nghost);
+    Lp.apply(amrlev, mglev, q, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    MultiFab::Copy(w,q,0,0,ncomp,nghost);
+
+    PipelinedReduce reduce;
+
+    Real rnorm = 0, rnorm0 = 0;
+    Real rho_1 = 0, alpha = 0;
+    int  ret = 0;
+    iter = 1;
+
+    for (; iter <= maxiter+1; ++iter)
+    {
+        // (r,r), (w,r) and |r| are reduced behind q = A w
+        Real red[3] = { dotxy(r,r,true), dotxy(w,r,true), norm_inf(r,true) };
+        reduce.start(red, 3, Lp.BottomCommunicator());
+        Lp.apply(amrlev, mglev, q, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        reduce.wait();
+
+        rnorm = red[2];
+
+        if ( iter == 1 )
+        {
+            rnorm0 = rnorm;
+            if ( verbose > 0 )
+            {
+                amrex::Print() << "MLCGSolver_PipelinedCG: Initial error (error0) :        " << rnorm0 << '\n';
+            }
+            if ( rnorm0 == 0 || rnorm0 < eps_abs )
+            {
+                if ( verbose > 0 ) {
+                    amrex::Print() << "MLCGSolver_PipelinedCG: niter = 0,"
+                                   << ", rnorm = " << rnorm
+                                   << ", eps_abs = " << eps_abs << std::endl;
+                }
+                iter = 1;
+                return ret;
+            }
+        }
+        else
+        {
+            if ( verbose > 2 )
+            {
+                amrex::Print() << "MLCGSolver_PipelinedCG:       Iteration"
+                               << std::setw(4) << iter-1
+                               << " rel. err. "
+                               << rnorm/(rnorm0) << '\n';
+            }
+
+            // The residual of the previous iteration has converged; the last apply is wasted.
+            if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+            if ( iter == maxiter+1 ) break;
+        }
+
+        const Real rho = red[0];
+        if ( rho == 0 )
+        {
+            ret = 1; break;
+        }
+
+        Real beta = 0, denom = red[1];
+        if ( iter > 1 )
+        {
+            beta = rho/rho_1;
+            denom -= beta*rho/alpha;
+        }
+        if ( denom != Real(0.0) )
+        {
+            alpha = rho/denom;
+        }
+        else
+        {
+            ret = 1; break;
+        }
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedCG:"
+                           << " iter " << iter
+                           << " rho " << rho
+                           << " alpha " << alpha << '\n';
+        }
+
+        if ( iter == 1 )
+        {
+            MultiFab::Copy(z,q,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(z, q, beta, z, nghost);
+            sxay(s, w, beta, s, nghost);
+            sxay(p, r, beta, p, nghost);
+        }
+        sxay(sol, sol, alpha, p, nghost);
+        sxay(  r,   r,-alpha, s, nghost);
+        sxay(  w,   w,-alpha, z, nghost);
+
+        rho_1 = rho;
+    }
+
+    // iter counts the operator applies in the loop, one more than the completed iterations
+    --iter;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipelinedCG: Final Iteration"
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipelinedCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
 Real
 MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
 {
@@ -406,6 +1205,34 @@ MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
     return result;
 }
 
+void
+MLCGSolver::dotxy_comp (const MultiFab& r, const MultiFab& z, Vector<Real>& result, bool local)
+{
+    const int ncomp = r.nComp();
+    result.resize(ncomp);
+    for (int n = 0; n < ncomp; ++n) {
+        result[n] = MultiFab::Dot(r, n, z, n, 1, 0, true);
+    }
+    if (!local) {
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+        ParallelAllReduce::Sum(result.data(), ncomp, Lp.BottomCommunicator());
+    }
+}
+
+void
+MLCGSolver::norm_inf_comp (const MultiFab& res, Vector<Real>& result, bool local)
+{
+    const int ncomp = res.nComp();
+    result.resize(ncomp);
+    for (int n = 0; n < ncomp; ++n) {
+        result[n] = res.norm0(n, 0, true);
+    }
+    if (!local) {
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+        ParallelAllReduce::Max(result.data(), ncomp, Lp.BottomCommunicator());
+    }
+}
+
 Real
 MLCGSolver::norm_inf (const MultiFab& res, bool local)
 {
@@ -492,6 +492,89 @@ MLCellLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
     }
 }
 
+int
+MLCellLinOp::smootherHaloDepth () const
+{
+    if (isCrossStencil() && !isTensorOp() && supportHaloSmoothing() && !info.use_chebyshev) {
+        return std::max(info.halo_depth, 1);
+    } else {
+        return 1;
+    }
+}
+
+// With a halo depth of d > 1, the ghost cells of sol are filled once every d red/black
+// sweeps.  In between, each sweep also updates the ghost cells covered by other grids,
+// as far as they are still correct, i.e., within d-1-(sweeps since the exchange) of the
+// valid box.  Ghost cells next to physical and coarse/fine boundaries are not updated,
+// so their values lag behind until the next exchange.
+void
+MLCellLinOp::smoothIters (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                          int niters, bool skip_fillboundary) const
+{
+    const int depth = std::min(smootherHaloDepth(), sol.nGrowVect().min());
+    if (info.use_chebyshev || depth < 2 || niters < 1 || sol.boxArray() != m_grids[amrlev][mglev]
+        || sol.DistributionMap() != m_dmap[amrlev][mglev])
+    {
+        MLLinOp::smoothIters(amrlev, mglev, sol, rhs, niters, skip_fillboundary);
+        return;
+    }
+
+    BL_PROFILE("MLCellLinOp::smoothIters()");
+
+    const int ncomp = getNComp();
+    const auto& period = m_geom[amrlev][mglev].periodicity();
+
+    if (m_halo_cover.empty()) {
+        m_halo_cover.resize(m_num_amr_levels);
+        m_halo_rhs.resize(m_num_amr_levels);
+        for (int alev = 0; alev < m_num_amr_levels; ++alev) {
+            m_halo_cover[alev].resize(m_num_mg_levels[alev]);
+            m_halo_rhs[alev].resize(m_num_mg_levels[alev]);
+        }
+    }
+    auto& cover = m_halo_cover[amrlev][mglev];
+    if (cover == nullptr || cover->nGrow() < depth) {
+        cover = std::make_unique<iMultiFab>(m_grids[amrlev][mglev], m_dmap[amrlev][mglev], 1, depth);
+        cover->setVal(0);
+        cover->setVal(1, 0);
+        cover->FillBoundary(period);
+    }
+    auto& rhs_h = m_halo_rhs[amrlev][mglev];
+    if (rhs_h == nullptr || rhs_h->nGrow() < depth-1) {
+        rhs_h = std::make_unique<MultiFab>(m_grids[amrlev][mglev], m_dmap[amrlev][mglev], ncomp, depth-1);
+    }
+
+    MultiFab::Copy(*rhs_h, rhs, 0, 0, ncomp, 0);
+    rhs_h->FillBoundary_nowait(0, ncomp, IntVect(depth-1), period);
+    if (!skip_fillboundary) {
+        sol.FillBoundary_nowait(0, ncomp, IntVect(depth), period);
+        sol.FillBoundary_finish();
+    }
+    rhs_h->FillBoundary_finish();
+
+    int nsweeps = 0; // since the last exchange
+    for (int iter = 0; iter < niters; ++iter)
+    {
+        for (int redblack = 0; redblack < 2; ++redblack)
+        {
+            if (nsweeps == depth) {
+                sol.FillBoundary(0, ncomp, IntVect(depth), period);
+                nsweeps = 0;
+            }
+            applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution, nullptr, true);
+#ifdef AMREX_SOFT_PERF_COUNTERS
+            perf_counters.smooth(sol);
+#endif
+            Fsmooth(amrlev, mglev, sol, rhs, redblack);
+            const int width = depth-1-nsweeps;
+            if (width > 0) {
+                FsmoothHalo(amrlev, mglev, sol, *rhs_h, *cover, redblack, width);
+            }
+            ++nsweeps;
+        }
+    }
+}
+
 void
 MLCellLinOp::updateSolBC (int amrlev, const MultiFab& crse_bcdata) const
 {
@@ -568,6 +651,220 @@ MLCellLinOp::correctionResidual (int amrlev, int mglev, MultiFab& resid, MultiFa
     MultiFab::Xpay(resid, Real(-1.0), b, 0, 0, ncomp, 0);
 }
 
+void
+MLCellLinOp::smoothFloat (int amrlev, int mglev, FloatMultiFab& sol, const FloatMultiFab& rhs,
+                          bool skip_fillboundary) const
+{
+    BL_PROFILE("MLCellLinOp::smoothFloat()");
+    for (int redblack = 0; redblack < 2; ++redblack)
+    {
+        applyBCFloat(amrlev, mglev, sol, skip_fillboundary);
+        FsmoothFloat(amrlev, mglev, sol, rhs, redblack);
+        skip_fillboundary = false;
+    }
+}
+
+void
+MLCellLinOp::correctionResidualFloat (int amrlev, int mglev, FloatMultiFab& resid,
+                                      FloatMultiFab& x, const FloatMultiFab& b) const
+{
+    BL_PROFILE("MLCellLinOp::correctionResidualFloat()");
+    const int ncomp = getNComp();
+    applyBCFloat(amrlev, mglev, x);
+    FapplyFloat(amrlev, mglev, resid, x);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(resid,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<float> const& rfab = resid.array(mfi);
+        Array4<float const> const& bfab = b.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            rfab(i,j,k,n) = bfab(i,j,k,n) - rfab(i,j,k,n);
+        });
+    }
+}
+
+void
+MLCellLinOp::restrictionFloat (int amrlev, int cmglev, FloatMultiFab& crse,
+                               const FloatMultiFab& fine) const
+{
+    BL_PROFILE("MLCellLinOp::restrictionFloat()");
+    const int ncomp = getNComp();
+
+    Dim3 ratio3 = {1,1,1};
+    IntVect ratio = (amrlev > 0) ? IntVect(2) : mg_coarsen_ratio_vec[cmglev-1];
+    AMREX_D_TERM(ratio3.x = ratio[0];,
+                 ratio3.y = ratio[1];,
+                 ratio3.z = ratio[2];);
+    const float volfrac = 1.f / static_cast<float>(AMREX_D_TERM(ratio[0],*ratio[1],*ratio[2]));
+
+    const bool need_parallel_copy = !amrex::isMFIterSafe(crse, fine);
+    FloatMultiFab ctmp;
+    if (need_parallel_copy) {
+        ctmp.define(amrex::coarsen(fine.boxArray(), ratio), fine.DistributionMap(), ncomp, 0);
+    }
+    FloatMultiFab& cdst = (need_parallel_copy) ? ctmp : crse;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(cdst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<float> const& cfab = cdst.array(mfi);
+        Array4<float const> const& ffab = fine.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            float r = 0.f;
+            for (int kk = k*ratio3.z; kk < (k+1)*ratio3.z; ++kk) {
+            for (int jj = j*ratio3.y; jj < (j+1)*ratio3.y; ++jj) {
+            for (int ii = i*ratio3.x; ii < (i+1)*ratio3.x; ++ii) {
+                r += ffab(ii,jj,kk,n);
+            }}}
+            cfab(i,j,k,n) = r*volfrac;
+        });
+    }
+
+    if (need_parallel_copy) {
+        crse.ParallelCopy(ctmp, 0, 0, ncomp);
+    }
+}
+
+void
+MLCellLinOp::interpolationFloat (int amrlev, int fmglev, FloatMultiFab& fine,
+                                 const FloatMultiFab& crse) const
+{
+    BL_PROFILE("MLCellLinOp::interpolationFloat()");
+    const int ncomp = getNComp();
+
+    Dim3 ratio3 = {1,1,1};
+    IntVect ratio = (amrlev > 0) ? IntVect(2) : mg_coarsen_ratio_vec[fmglev];
+    AMREX_D_TERM(ratio3.x = ratio[0];,
+                 ratio3.y = ratio[1];,
+                 ratio3.z = ratio[2];);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(fine,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<float const> const& cfab = crse.const_array(mfi);
+        Array4<float> const& ffab = fine.array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            int ic = amrex::coarsen(i,ratio3.x);
+            int jc = amrex::coarsen(j,ratio3.y);
+            int kc = amrex::coarsen(k,ratio3.z);
+            ffab(i,j,k,n) += cfab(ic,jc,kc,n);
+        });
+    }
+}
+
+void
+MLCellLinOp::applyBCFloat (int amrlev, int mglev, FloatMultiFab& in, bool skip_fillboundary) const
+{
+    BL_PROFILE("MLCellLinOp::applyBCFloat()");
+    AMREX_ALWAYS_ASSERT(isCrossStencil() && !isTensorOp());
+
+    const int ncomp = getNComp();
+    if (!skip_fillboundary) {
+        in.FillBoundary(0, ncomp, m_geom[amrlev][mglev].periodicity(), true);
+    }
+
+    const int imaxorder = maxorder;
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    AMREX_D_TERM(const Real dxi = dxinv[0];,
+                 const Real dyi = dxinv[1];,
+                 const Real dzi = dxinv[2];);
+
+    const auto& maskvals = m_maskvals[amrlev][mglev];
+    const auto& bcondloc = *m_bcondloc[amrlev][mglev];
+
+    // homogeneous, so the boundary values are never read
+    FArrayBox foofab(Box::TheUnitBox(),ncomp);
+    const auto& foo = foofab.const_array();
+
+    const int hidden_direction = hiddenDirection();
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.SetDynamic(true);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(in, mfi_info); mfi.isValid(); ++mfi)
+    {
+        const Box& vbx = mfi.validbox();
+        const auto& iofab = in.array(mfi);
+
+        const auto & bdlv = bcondloc.bndryLocs(mfi);
+        const auto & bdcv = bcondloc.bndryConds(mfi);
+
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            if (hidden_direction == idim) continue;
+            const Orientation olo(idim,Orientation::low);
+            const Orientation ohi(idim,Orientation::high);
+            const Box blo = amrex::adjCellLo(vbx, idim);
+            const Box bhi = amrex::adjCellHi(vbx, idim);
+            const int blen = vbx.length(idim);
+            const auto& mlo = maskvals[olo].const_array(mfi);
+            const auto& mhi = maskvals[ohi].const_array(mfi);
+            for (int icomp = 0; icomp < ncomp; ++icomp) {
+                const BoundCond bctlo = bdcv[icomp][olo];
+                const BoundCond bcthi = bdcv[icomp][ohi];
+                const Real bcllo = bdlv[icomp][olo];
+                const Real bclhi = bdlv[icomp][ohi];
+                if (idim == 0) {
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(blo, i, j, k,
+                    {
+                        mllinop_apply_bc_x(0, i, j, k, blen, iofab, mlo, bctlo, bcllo, foo,
+                                           imaxorder, dxi, 0, icomp);
+                    });
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bhi, i, j, k,
+                    {
+                        mllinop_apply_bc_x(1, i, j, k, blen, iofab, mhi, bcthi, bclhi, foo,
+                                           imaxorder, dxi, 0, icomp);
+                    });
+                }
+#if (AMREX_SPACEDIM > 1)
+                else if (idim == 1) {
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(blo, i, j, k,
+                    {
+                        mllinop_apply_bc_y(0, i, j, k, blen, iofab, mlo, bctlo, bcllo, foo,
+                                           imaxorder, dyi, 0, icomp);
+                    });
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bhi, i, j, k,
+                    {
+                        mllinop_apply_bc_y(1, i, j, k, blen, iofab, mhi, bcthi, bclhi, foo,
+                                           imaxorder, dyi, 0, icomp);
+                    });
+                }
+#endif
+#if (AMREX_SPACEDIM > 2)
+                else {
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(blo, i, j, k,
+                    {
+                        mllinop_apply_bc_z(0, i, j, k, blen, iofab, mlo, bctlo, bcllo, foo,
+                                           imaxorder, dzi, 0, icomp);
+                    });
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bhi, i, j, k,
+                    {
+                        mllinop_apply_bc_z(1, i, j, k, blen, iofab, mhi, bcthi, bclhi, foo,
+                                           imaxorder, dzi, 0, icomp);
+                    });
+                }
+#endif
+            }
+        }
+    }
+}
+
 void
 MLCellLinOp::applyBC (int amrlev, int mglev, MultiFab& in, BCMode bc_mode, StateMode,
                       const MLMGBndry* bndry, bool skip_fillboundary) const
@@ -0,0 +1,305 @@
+#include <AMReX_MLDirectSolver.H>
+#include <AMReX_MLAMGSolver.H>
+#include <AMReX_ParallelReduce.H>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace amrex {
+
+namespace {
+
+using Matrix = MLAMGSolver::Matrix;
+
+// Reverse Cuthill-McKee ordering of the symmetrized pattern of A.  Each connected
+// component starts from a pseudo-peripheral node.  Returns the new-to-old map.
+Vector<int> rcm_ordering (Matrix const& A)
+{
+    const int n = A.nrows;
+
+    Vector<Vector<int> > adj(n);
+    for (int i = 0; i < n; ++i) {
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            const int j = A.col[e];
+            if (j != i) {
+                adj[i].push_back(j);
+                adj[j].push_back(i);
+            }
+        }
+    }
+    for (auto& a : adj) {
+        std::sort(a.begin(), a.end());
+        a.erase(std::unique(a.begin(), a.end()), a.end());
+    }
+
+    Vector<int> dist(n, -1);
+    Vector<int> touched;
+    // BFS from s.  Returns the node of minimum degree in the last level, and its level.
+    auto farthest = [&] (int s, int& ecc) -> int
+    {
+        for (int i : touched) dist[i] = -1;
+        touched.clear();
+        std::queue<int> q;
+        q.push(s);
+        dist[s] = 0;
+        touched.push_back(s);
+        int t = s;
+        while (!q.empty()) {
+            const int u = q.front();
+            q.pop();
+            if (dist[u] > dist[t] ||
+                (dist[u] == dist[t] && adj[u].size() < adj[t].size())) {
+                t = u;
+            }
+            for (int v : adj[u]) {
+                if (dist[v] < 0) {
+                    dist[v] = dist[u] + 1;
+                    touched.push_back(v);
+                    q.push(v);
+                }
+            }
+        }
+        ecc = dist[t];
+        return t;
+    };
+
+    Vector<int> order;
+    order.reserve(n);
+    Vector<char> visited(n, 0);
+    Vector<int> nbrs;
+    for (int seed = 0; seed < n; ++seed)
+    {
+        if (visited[seed]) continue;
+
+        int r = seed;
+        int ecc_r;
+        int x = farthest(r, ecc_r);
+        for (int pass = 0; pass < 4; ++pass) {
+            int ecc_x;
+            const int y = farthest(x, ecc_x);
+            if (ecc_x <= ecc_r) break;
+            r = x;
+            ecc_r = ecc_x;
+            x = y;
+        }
+
+        Long head = order.size();
+        order.push_back(r);
+        visited[r] = 1;
+        while (head < order.size()) {
+            const int u = order[head++];
+            nbrs.clear();
+            for (int v : adj[u]) {
+                if (!visited[v]) {
+                    visited[v] = 1;
+                    nbrs.push_back(v);
+                }
+            }
+            std::sort(nbrs.begin(), nbrs.end(), [&] (int a, int b) {
+                return adj[a].size() < adj[b].size() || (adj[a].size() == adj[b].size() && a < b);
+            });
+            order.insert(order.end(), nbrs.begin(), nbrs.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+}
+
+MLDirectSolver::MLDirectSolver (MLLinOp& a_lp)
+    : Lp(a_lp)
+{}
+
+MLDirectSolver::~MLDirectSolver ()
+{}
+
+void
+MLDirectSolver::setup ()
+{
+    BL_PROFILE("MLDirectSolver::setup()");
+
+    const Matrix A = MLAMGSolver::assemble(Lp, m_box_offset, root);
+    m_n = static_cast<int>(m_box_offset.back());
+
+    if (ParallelDescriptor::MyProc(Lp.BottomCommunicator()) != root) return;
+
+    const int n = m_n;
+    m_perm = rcm_ordering(A);
+    Vector<int> iperm(n);
+    for (int i = 0; i < n; ++i) {
+        iperm[m_perm[i]] = i;
+    }
+
+    // The envelope of the symmetrized pattern.  The factors without pivoting
+    // have no fill outside of it.
+    m_first.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_first[i] = i;
+    }
+    for (int i = 0; i < n; ++i) {
+        const int p = iperm[i];
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            const int q = iperm[A.col[e]];
+            if (q < p) {
+                m_first[p] = std::min(m_first[p], q);
+            } else {
+                m_first[q] = std::min(m_first[q], p);
+            }
+        }
+    }
+    m_ptr.resize(n+1);
+    m_ptr[0] = 0;
+    for (int i = 0; i < n; ++i) {
+        m_ptr[i+1] = m_ptr[i] + (i - m_first[i] + 1);
+    }
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(2*m_ptr[n] <= max_entries,
+                                     "MLDirectSolver: the bottom level is too big, coarsen it further");
+
+    m_lower.assign(m_ptr[n], 0.0);
+    m_upper.assign(m_ptr[n], 0.0);
+    for (int i = 0; i < n; ++i) {
+        const int p = iperm[i];
+        for (int e = A.rowptr[i]; e < A.rowptr[i+1]; ++e) {
+            const int q = iperm[A.col[e]];
+            if (q < p) {
+                m_lower[m_ptr[p] + (q - m_first[p])] += A.val[e];
+            } else {
+                m_upper[m_ptr[q] + (p - m_first[q])] += A.val[e];
+            }
+        }
+    }
+
+    factor();
+
+    if (verbose > 0) {
+        amrex::Print(root, Lp.BottomCommunicator())
+            << "MLDirectSolver: " << n << " rows, " << getNumEntries()
+            << " entries in the factors\n";
+    }
+}
+
+// Doolittle LU in envelope storage.  Row j of L is computed before column j of U,
+// and each entry is a dot product of two contiguous segments.
+void
+MLDirectSolver::factor ()
+{
+    BL_PROFILE("MLDirectSolver::factor()");
+
+    const int n = m_n;
+
+    Real amax = 0.0;
+    for (int j = 0; j < n; ++j) {
+        amax = std::max(amax, std::abs(m_upper[m_ptr[j] + (j - m_first[j])]));
+    }
+    const Real tiny = amax * Real(1.e-12);
+
+    for (int j = 0; j < n; ++j)
+    {
+        const int fj = m_first[j];
+        Real* Lj = m_lower.data() + m_ptr[j];
+        Real* Uj = m_upper.data() + m_ptr[j];
+
+        for (int c = fj; c < j; ++c) {
+            const int fc = m_first[c];
+            const Real* Uc = m_upper.data() + m_ptr[c];
+            Real s = Lj[c-fj];
+            for (int k = std::max(fj,fc); k < c; ++k) {
+                s -= Lj[k-fj] * Uc[k-fc];
+            }
+            const Real piv = Uc[c-fc];
+            Lj[c-fj] = (piv != 0.0) ? s/piv : Real(0.0);
+        }
+
+        for (int r = fj; r <= j; ++r) {
+            const int fr = m_first[r];
+            const Real* Lr = m_lower.data() + m_ptr[r];
+            Real s = Uj[r-fj];
+            for (int k = std::max(fj,fr); k < r; ++k) {
+                s -= Lr[k-fr] * Uj[k-fj];
+            }
+            Uj[r-fj] = s;
+        }
+
+        // The zero pivot of a singular matrix is skipped by solve.
+        if (std::abs(Uj[j-fj]) <= tiny) {
+            Uj[j-fj] = 0.0;
+        }
+    }
+}
+
+void
+MLDirectSolver::solve (MultiFab& sol, const MultiFab& rhs)
+{
+    BL_PROFILE("MLDirectSolver::solve()");
+
+    const int n = m_n;
+    MPI_Comm comm = Lp.BottomCommunicator();
+
+    MultiFab hmf(sol.boxArray(), sol.DistributionMap(), 1, 0, MFInfo().SetArena(The_Pinned_Arena()));
+    MultiFab::Copy(hmf, rhs, 0, 0, 1, 0);
+    Gpu::streamSynchronize();
+
+    Vector<Real> x(n, 0.0);
+    for (MFIter mfi(hmf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const auto lo = amrex::lbound(bx);
+        const auto len = amrex::length(bx);
+        const Long offset = m_box_offset[mfi.index()];
+        const auto& a = hmf.const_array(mfi);
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            x[offset + (i-lo.x) + ((j-lo.y) + (k-lo.z)*len.y)*len.x] = a(i,j,k);
+        });
+    }
+    ParallelReduce::Sum(x.data(), n, root, comm);
+
+    if (ParallelDescriptor::MyProc(comm) == root)
+    {
+        Vector<Real> y(n);
+        for (int i = 0; i < n; ++i) {
+            y[i] = x[m_perm[i]];
+        }
+        for (int j = 0; j < n; ++j) {
+            const int fj = m_first[j];
+            const Real* Lj = m_lower.data() + m_ptr[j];
+            Real s = y[j];
+            for (int c = fj; c < j; ++c) {
+                s -= Lj[c-fj] * y[c];
+            }
+            y[j] = s;
+        }
+        for (int j = n-1; j >= 0; --j) {
+            const int fj = m_first[j];
+            const Real* Uj = m_upper.data() + m_ptr[j];
+            const Real piv = Uj[j-fj];
+            const Real xj = (piv != 0.0) ? y[j]/piv : Real(0.0);
+            y[j] = xj;
+            for (int r = fj; r < j; ++r) {
+                y[r] -= Uj[r-fj] * xj;
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            x[m_perm[i]] = y[i];
+        }
+    }
+
+    ParallelDescriptor::Bcast(x.data(), n, root, comm);
+
+    for (MFIter mfi(hmf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const auto lo = amrex::lbound(bx);
+        const auto len = amrex::length(bx);
+        const Long offset = m_box_offset[mfi.index()];
+        const auto& a = hmf.array(mfi);
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            a(i,j,k) = x[offset + (i-lo.x) + ((j-lo.y) + (k-lo.z)*len.y)*len.x];
+        });
+    }
+    MultiFab::Copy(sol, hmf, 0, 0, 1, 0);
+}
+
+}
@@ -4,6 +4,7 @@
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_EBMultiFabUtil.H>
 #include <AMReX_EBFArrayBox.H>
+#include <AMReX_Scan.H>
 
 #include <AMReX_MLABecLap_K.H>
 #include <AMReX_MLEBABecLap_K.H>
@@ -63,12 +64,14 @@ MLEBABecLap::define (const Vector<Geometry>& a_geom,
     m_cc_mask.resize(m_num_amr_levels);
     m_eb_phi.resize(m_num_amr_levels);
     m_eb_b_coeffs.resize(m_num_amr_levels);
+    m_cut_stencil.resize(m_num_amr_levels);
     for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
     {
         m_a_coeffs[amrlev].resize(m_num_mg_levels[amrlev]);
         m_b_coeffs[amrlev].resize(m_num_mg_levels[amrlev]);
         m_cc_mask[amrlev].resize(m_num_mg_levels[amrlev]);
         m_eb_b_coeffs[amrlev].resize(m_num_mg_levels[amrlev]);
+        m_cut_stencil[amrlev].resize(m_num_mg_levels[amrlev]);
         for (int mglev = 0; mglev < m_num_mg_levels[amrlev]; ++mglev)
         {
             m_a_coeffs[amrlev][mglev].define(m_grids[amrlev][mglev],
@@ -117,6 +120,7 @@ MLEBABecLap::setScalars (Real a, Real b)
             m_a_coeffs[amrlev][0].setVal(0.0);
         }
     }
+    m_needs_update = true;
 }
 
 void
@@ -259,6 +263,8 @@ MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, const MultiFab& be
 
     if (phi_on_centroid)
       m_eb_phi[amrlev]->FillBoundary(m_geom[amrlev][0].periodicity());
+
+    m_needs_update = true;
 }
 
 void
@@ -321,6 +327,8 @@ MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, Real beta)
 
     if (phi_on_centroid)
       m_eb_phi[amrlev]->FillBoundary(m_geom[amrlev][0].periodicity());
+
+    m_needs_update = true;
 }
 
 void
@@ -387,6 +395,8 @@ MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, Vector<Real> const
 
     if (phi_on_centroid)
       m_eb_phi[amrlev]->FillBoundary(m_geom[amrlev][0].periodicity());
+
+    m_needs_update = true;
 }
 
 void
@@ -463,6 +473,8 @@ MLEBABecLap::setEBHomogDirichlet (int amrlev, const MultiFab& beta)
 
     if (phi_on_centroid)
       m_eb_phi[amrlev]->FillBoundary(m_geom[amrlev][0].periodicity());
+
+    m_needs_update = true;
 }
 
 void
@@ -525,6 +537,8 @@ MLEBABecLap::setEBHomogDirichlet (int amrlev, Real beta)
 
     if (phi_on_centroid)
       m_eb_phi[amrlev]->FillBoundary(m_geom[amrlev][0].periodicity());
+
+    m_needs_update = true;
 }
 
 void
@@ -591,6 +605,8 @@ MLEBABecLap::setEBHomogDirichlet (int amrlev, Vector<Real> const& hv_beta)
 
     if (phi_on_centroid)
       m_eb_phi[amrlev]->FillBoundary(m_geom[amrlev][0].periodicity());
+
+    m_needs_update = true;
 }
 
 void
@@ -712,6 +728,8 @@ MLEBABecLap::prepareForSolve ()
         }
     }
 
+    buildCutCellStencils();
+
     m_needs_update = false;
 }
 
@@ -860,8 +878,9 @@ MLEBABecLap::normalize (int amrlev, int mglev, MultiFab& mf) const
         : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
     auto fcent = (factory) ? factory->getFaceCent()
         : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
-    const MultiCutFab* barea = (factory) ? &(factory->getBndryArea()) : nullptr;
-    const MultiCutFab* bcent = (factory) ? &(factory->getBndryCent()) : nullptr;
+    const EBCutCellData* cutcells = (factory) ? factory->getCutCellData() : nullptr;
+    const MultiCutFab* barea = (factory && !cutcells) ? &(factory->getBndryArea()) : nullptr;
+    const MultiCutFab* bcent = (factory && !cutcells) ? &(factory->getBndryCent()) : nullptr;
 
     bool is_eb_dirichlet =  isEBDirichlet();
 
@@ -908,22 +927,38 @@ MLEBABecLap::normalize (int amrlev, int mglev, MultiFab& mf) const
             AMREX_D_TERM(Array4<Real const> const& fcxfab = fcent[0]->const_array(mfi);,
                          Array4<Real const> const& fcyfab = fcent[1]->const_array(mfi);,
                          Array4<Real const> const& fczfab = fcent[2]->const_array(mfi););
-            Array4<Real const> const& bafab = barea->const_array(mfi);
-            Array4<Real const> const& bcfab = bcent->const_array(mfi);
 
             bool beta_on_centroid = (m_beta_loc == Location::FaceCentroid);
 
-            AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
-            {
-                mlebabeclap_normalize(tbx, fab, ascalar, afab,
-                                      AMREX_D_DECL(dhx, dhy, dhz),
-                                      AMREX_D_DECL(bxfab, byfab, bzfab),
-                                      ccmfab, flagfab, vfracfab,
-                                      AMREX_D_DECL(apxfab,apyfab,apzfab),
-                                      AMREX_D_DECL(fcxfab,fcyfab,fczfab),
-                                      bafab, bcfab, bebfab, is_eb_dirichlet,
-                                      beta_on_centroid, ncomp);
-            });
+            if (cutcells) {
+                CutCellConstArray4 const& bafab = cutcells->const_array(mfi, EBCutCellData::BndryArea);
+                CutCellConstArray4 const& bcfab = cutcells->const_array(mfi, EBCutCellData::BndryCent);
+                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
+                {
+                    mlebabeclap_normalize(tbx, fab, ascalar, afab,
+                                          AMREX_D_DECL(dhx, dhy, dhz),
+                                          AMREX_D_DECL(bxfab, byfab, bzfab),
+                                          ccmfab, flagfab, vfracfab,
+                                          AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                          AMREX_D_DECL(fcxfab,fcyfab,fczfab),
+                                          bafab, bcfab, bebfab, is_eb_dirichlet,
+                                          beta_on_centroid, ncomp);
+                });
+            } else {
+                Array4<Real const> const& bafab = barea->const_array(mfi);
+                Array4<Real const> const& bcfab = bcent->const_array(mfi);
+                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
+                {
+                    mlebabeclap_normalize(tbx, fab, ascalar, afab,
+                                          AMREX_D_DECL(dhx, dhy, dhz),
+                                          AMREX_D_DECL(bxfab, byfab, bzfab),
+                                          ccmfab, flagfab, vfracfab,
+                                          AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                          AMREX_D_DECL(fcxfab,fcyfab,fczfab),
+                                          bafab, bcfab, bebfab, is_eb_dirichlet,
+                                          beta_on_centroid, ncomp);
+                });
+            }
         }
     }
 }
@@ -1197,9 +1232,223 @@ MLEBABecLap::update ()
         }
     }
 
+    buildCutCellStencils();
+
     m_needs_update = false;
 }
 
+void
+MLEBABecLap::buildCutCellStencils ()
+{
+    // Reset first, so that Fapply below uses the geometric kernels.
+    for (auto& v : m_cut_stencil) {
+        for (auto& s : v) {
+            s.reset();
+        }
+    }
+
+    if (!m_cache_stencil || m_phi_loc == Location::CellCentroid) return;
+
+    BL_PROFILE("MLEBABecLap::buildCutCellStencils()");
+
+    for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev) {
+        for (int mglev = 0; mglev < m_num_mg_levels[amrlev]; ++mglev) {
+            m_cut_stencil[amrlev][mglev] = makeCutCellStencil(amrlev, mglev);
+        }
+    }
+}
+
+std::unique_ptr<MLEBABecLap::CutCellStencil>
+MLEBABecLap::makeCutCellStencil (int amrlev, int mglev) const
+{
+    auto factory = dynamic_cast<EBFArrayBoxFactory const*>(m_factory[amrlev][mglev].get());
+    if (!factory) return nullptr;
+
+    const int ncomp = getNComp();
+    const BoxArray& ba = m_grids[amrlev][mglev];
+    const DistributionMapping& dm = m_dmap[amrlev][mglev];
+    const auto& flags = factory->getMultiEBCellFlagFab();
+
+    auto r = std::make_unique<CutCellStencil>();
+    r->row.define(ba, dm, 1, 0);
+    r->rowptr.define(ba, dm);
+    r->col.define(ba, dm);
+    r->val.define(ba, dm);
+    r->ebval.define(ba, dm);
+
+    // Number the cut cells of each box.
+    LayoutData<int> ncut(ba, dm);
+    for (MFIter mfi(r->row); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        auto const& row = r->row.array(mfi);
+        ncut[mfi] = 0;
+        if (flags[mfi].getType(bx) != FabType::singlevalued) {
+            r->row[mfi].setVal<RunOn::Device>(-1);
+            continue;
+        }
+        auto const& flag = flags.const_array(mfi);
+        const int npts = bx.numPts();
+        ncut[mfi] = Scan::PrefixSum<int>(npts,
+            [=] AMREX_GPU_DEVICE (int ioff) noexcept -> int
+            {
+                const Dim3 cell = bx.atOffset(ioff).dim3();
+                return flag(cell.x,cell.y,cell.z).isSingleValued() ? 1 : 0;
+            },
+            [=] AMREX_GPU_DEVICE (int ioff, int ps) noexcept
+            {
+                const Dim3 cell = bx.atOffset(ioff).dim3();
+                row(cell.x,cell.y,cell.z) = flag(cell.x,cell.y,cell.z).isSingleValued() ? ps : -1;
+            },
+            Scan::Type::exclusive);
+    }
+
+    // The operator is linear and the stencil of a cut cell is within
+    // [-1,1]^3.  Applying it to x that is one on every third cell in each
+    // direction gives at each cut cell the weight of the one neighbor that is
+    // one.  3^AMREX_SPACEDIM such x give all the weights.
+    constexpr int nsten = 27;
+    constexpr int center = 13;
+    LayoutData<Gpu::DeviceVector<Real> > dense(ba, dm);
+    for (MFIter mfi(r->row); mfi.isValid(); ++mfi) {
+        dense[mfi].resize(static_cast<std::size_t>(ncut[mfi])*nsten*ncomp, 0.0);
+    }
+
+    const int is_eb_inhomog = m_is_eb_inhomog;
+    m_is_eb_inhomog = false;
+
+    MultiFab x(ba, dm, ncomp, 1);
+    MultiFab y(ba, dm, ncomp, 0);
+    const int ncolors = AMREX_D_TERM(3,*3,*3);
+    for (int color = 0; color < ncolors; ++color)
+    {
+        const GpuArray<int,3> cv{color%3, (AMREX_SPACEDIM > 1) ? color/3%3 : 0,
+                                 (AMREX_SPACEDIM > 2) ? color/9 : 0};
+        for (MFIter mfi(x); mfi.isValid(); ++mfi)
+        {
+            auto const& xa = x.array(mfi);
+            amrex::ParallelFor(mfi.fabbox(), ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                const bool on = ((i%3+3)%3 == cv[0]) && ((j%3+3)%3 == cv[1])
+                    &&          ((k%3+3)%3 == cv[2]);
+                xa(i,j,k,n) = on ? 1.0 : 0.0;
+            });
+        }
+
+        Fapply(amrlev, mglev, y, x);
+
+        for (MFIter mfi(y); mfi.isValid(); ++mfi)
+        {
+            if (ncut[mfi] == 0) continue;
+            auto const& ya = y.const_array(mfi);
+            auto const& row = r->row.const_array(mfi);
+            Real* p = dense[mfi].data();
+            amrex::ParallelFor(mfi.validbox(), ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                const int m = row(i,j,k);
+                if (m >= 0) {
+                    // offsets in [-1,1] of the neighbor that is one
+                    const int ox = (cv[0]-(i%3+3)%3+4)%3 - 1;
+                    const int oy = (cv[1]-(j%3+3)%3+4)%3 - 1;
+                    const int oz = (cv[2]-(k%3+3)%3+4)%3 - 1;
+                    const int c = (ox+1) + 3*(oy+1) + 9*(oz+1);
+                    p[(m*nsten+c)*ncomp+n] = ya(i,j,k,n);
+                }
+            });
+        }
+    }
+
+    // The inhomogeneous EB Dirichlet term is the operator applied to zero.
+    const bool has_ebval = isEBDirichlet() && mglev == 0 && m_eb_phi[amrlev];
+    if (has_ebval)
+    {
+        x.setVal(0.0);
+        m_is_eb_inhomog = true;
+        Fapply(amrlev, mglev, y, x);
+        for (MFIter mfi(y); mfi.isValid(); ++mfi)
+        {
+            if (ncut[mfi] == 0) continue;
+            r->ebval[mfi].resize(static_cast<std::size_t>(ncut[mfi])*ncomp);
+            auto const& ya = y.const_array(mfi);
+            auto const& row = r->row.const_array(mfi);
+            Real* p = r->ebval[mfi].data();
+            amrex::ParallelFor(mfi.validbox(), ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                const int m = row(i,j,k);
+                if (m >= 0) {
+                    p[m*ncomp+n] = ya(i,j,k,n);
+                }
+            });
+        }
+    }
+
+    m_is_eb_inhomog = is_eb_inhomog;
+
+    // Keep the nonzero weights, with the cell itself first.
+    for (MFIter mfi(r->row); mfi.isValid(); ++mfi)
+    {
+        const int n_cut = ncut[mfi];
+        if (n_cut == 0) continue;
+
+        Vector<Real> h_dense(dense[mfi].size());
+        Gpu::copyAsync(Gpu::deviceToHost, dense[mfi].begin(), dense[mfi].end(), h_dense.begin());
+        Gpu::streamSynchronize();
+
+        Vector<int> h_rowptr(n_cut+1);
+        Vector<int> h_col;
+        Vector<Real> h_val;
+        for (int m = 0; m < n_cut; ++m) {
+            h_rowptr[m] = h_col.size();
+            const Real* w = h_dense.data() + static_cast<std::size_t>(m)*nsten*ncomp;
+            for (int n = 0; n < ncomp; ++n) {
+                h_val.push_back(w[center*ncomp+n]);
+            }
+            h_col.push_back(center);
+            for (int c = 0; c < nsten; ++c) {
+                if (c == center) continue;
+                bool nonzero = false;
+                for (int n = 0; n < ncomp; ++n) {
+                    nonzero = nonzero || (w[c*ncomp+n] != 0.0);
+                }
+                if (nonzero) {
+                    h_col.push_back(c);
+                    for (int n = 0; n < ncomp; ++n) {
+                        h_val.push_back(w[c*ncomp+n]);
+                    }
+                }
+            }
+        }
+        h_rowptr[n_cut] = h_col.size();
+
+        r->rowptr[mfi].resize(h_rowptr.size());
+        r->col[mfi].resize(h_col.size());
+        r->val[mfi].resize(h_val.size());
+        Gpu::copyAsync(Gpu::hostToDevice, h_rowptr.begin(), h_rowptr.end(), r->rowptr[mfi].begin());
+        Gpu::copyAsync(Gpu::hostToDevice, h_col.begin(), h_col.end(), r->col[mfi].begin());
+        Gpu::copyAsync(Gpu::hostToDevice, h_val.begin(), h_val.end(), r->val[mfi].begin());
+        Gpu::streamSynchronize();
+    }
+
+    return r;
+}
+
+MLEBCutCellStencil
+MLEBABecLap::getCutCellStencil (int amrlev, int mglev, const MFIter& mfi) const
+{
+    const auto& s = *m_cut_stencil[amrlev][mglev];
+    MLEBCutCellStencil r;
+    r.row = s.row.const_array(mfi);
+    r.rowptr = s.rowptr[mfi].data();
+    r.col = s.col[mfi].data();
+    r.val = s.val[mfi].data();
+    r.ebval = s.ebval[mfi].empty() ? nullptr : s.ebval[mfi].data();
+    r.ncomp = getNComp();
+    return r;
+}
+
 void
 MLEBABecLap::getEBFluxes (const Vector<MultiFab*>& a_flux, const Vector<MultiFab*>& a_sol) const
 {
@@ -1224,7 +1473,8 @@ MLEBABecLap::getEBFluxes (const Vector<MultiFab*>& a_flux, const Vector<MultiFab
             auto area = (factory) ? factory->getAreaFrac()
                 : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
 
-            const MultiCutFab* bcent = (factory) ? &(factory->getBndryCent()) : nullptr;
+            const EBCutCellData* cutcells = (factory) ? factory->getCutCellData() : nullptr;
+            const MultiCutFab* bcent = (factory && !cutcells) ? &(factory->getBndryCent()) : nullptr;
 
             const bool is_eb_inhomog = m_is_eb_inhomog;
 
@@ -1254,19 +1504,31 @@ MLEBABecLap::getEBFluxes (const Vector<MultiFab*>& a_flux, const Vector<MultiFab
                     AMREX_D_TERM(Array4<Real const> const& apxfab = area[0]->const_array(mfi);,
                                  Array4<Real const> const& apyfab = area[1]->const_array(mfi);,
                                  Array4<Real const> const& apzfab = area[2]->const_array(mfi););
-                    Array4<Real const> const& bcfab = bcent->const_array(mfi);
                     Array4<Real const> const& bebfab = (is_eb_dirichlet)
                         ? m_eb_b_coeffs[amrlev][mglev]->const_array(mfi) : foo;
                     Array4<Real const> const& phiebfab = (is_eb_dirichlet && m_is_eb_inhomog)
                         ? m_eb_phi[amrlev]->const_array(mfi) : foo;
 
-                    AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
-                    {
-                        mlebabeclap_ebflux(i,j,k,n,febfab, xfab, flagfab, vfracfab,
-                                           AMREX_D_DECL(apxfab,apyfab,apzfab),
-                                           bcfab, bebfab, phiebfab,
-                                           is_eb_inhomog, dxinvarr);
-                    });
+                    if (cutcells) {
+                        CutCellConstArray4 const& bcfab
+                            = cutcells->const_array(mfi, EBCutCellData::BndryCent);
+                        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+                        {
+                            mlebabeclap_ebflux(i,j,k,n,febfab, xfab, flagfab, vfracfab,
+                                               AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                               bcfab, bebfab, phiebfab,
+                                               is_eb_inhomog, dxinvarr);
+                        });
+                    } else {
+                        Array4<Real const> const& bcfab = bcent->const_array(mfi);
+                        AMREX_HOST_DEVICE_FOR_4D ( bx, ncomp, i, j, k, n,
+                        {
+                            mlebabeclap_ebflux(i,j,k,n,febfab, xfab, flagfab, vfracfab,
+                                               AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                               bcfab, bebfab, phiebfab,
+                                               is_eb_inhomog, dxinvarr);
+                        });
+                    }
                 }
             }
         }
@@ -28,9 +28,18 @@ MLEBABecLap::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& in) c
         : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
     auto fcent = (factory) ? factory->getFaceCent()
         : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
-    const MultiCutFab* barea = (factory) ? &(factory->getBndryArea()) : nullptr;
-    const MultiCutFab* bcent = (factory) ? &(factory->getBndryCent()) : nullptr;
-    const auto         ccent = (factory) ? &(factory->getCentroid()) : nullptr;
+
+    bool beta_on_centroid = (m_beta_loc == Location::FaceCentroid);
+    bool  phi_on_centroid = (m_phi_loc  == Location::CellCentroid);
+
+    bool treat_phi_as_on_centroid = ( phi_on_centroid && (mglev == 0) );
+
+    // The compact cut cell data are used unless the centroid stencil needs the dense ones.
+    const EBCutCellData* cutcells = (factory && !treat_phi_as_on_centroid)
+        ? factory->getCutCellData() : nullptr;
+    const MultiCutFab* barea = (factory && !cutcells) ? &(factory->getBndryArea()) : nullptr;
+    const MultiCutFab* bcent = (factory && !cutcells) ? &(factory->getBndryCent()) : nullptr;
+    const auto         ccent = (factory && !cutcells) ? &(factory->getCentroid()) : nullptr;
 
     const bool is_eb_dirichlet =  isEBDirichlet();
     const bool is_eb_inhomog = m_is_eb_inhomog;
@@ -96,20 +105,38 @@ MLEBABecLap::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& in) c
             AMREX_D_TERM(Array4<Real const> const& fcxfab = fcent[0]->const_array(mfi);,
                          Array4<Real const> const& fcyfab = fcent[1]->const_array(mfi);,
                          Array4<Real const> const& fczfab = fcent[2]->const_array(mfi););
-            Array4<Real const> const& bafab = barea->const_array(mfi);
-            Array4<Real const> const& bcfab = bcent->const_array(mfi);
-            Array4<Real const> const& ccfab = ccent->const_array(mfi);
             Array4<Real const> const& bebfab = (is_eb_dirichlet)
                 ? m_eb_b_coeffs[amrlev][mglev]->const_array(mfi) : foo;
             Array4<Real const> const& phiebfab = (is_eb_dirichlet && is_eb_inhomog)
                 ? m_eb_phi[amrlev]->const_array(mfi) : foo;
 
-            bool beta_on_centroid = (m_beta_loc == Location::FaceCentroid);
-            bool  phi_on_centroid = (m_phi_loc  == Location::CellCentroid);
-
-            bool treat_phi_as_on_centroid = ( phi_on_centroid && (mglev == 0) );
-
-            if (treat_phi_as_on_centroid) {
+            if (m_cut_stencil[amrlev][mglev]) {
+               MLEBCutCellStencil const sten = getCutCellStencil(amrlev, mglev, mfi);
+               AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
+               {
+                   mlebabeclap_adotx_stencil(tbx, yfab, xfab, afab, AMREX_D_DECL(bxfab,byfab,bzfab),
+                                             flagfab, sten, is_eb_inhomog, dxinvarr,
+                                             ascalar, bscalar, ncomp);
+               });
+            } else if (cutcells) {
+               CutCellConstArray4 const& bafab = cutcells->const_array(mfi, EBCutCellData::BndryArea);
+               CutCellConstArray4 const& bcfab = cutcells->const_array(mfi, EBCutCellData::BndryCent);
+               AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
+               {
+                   mlebabeclap_adotx(tbx, yfab, xfab, afab, AMREX_D_DECL(bxfab,byfab,bzfab),
+                                     ccmfab, flagfab, vfracfab,
+                                     AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                     AMREX_D_DECL(fcxfab,fcyfab,fczfab),
+                                     bafab, bcfab, bebfab,
+                                     is_eb_dirichlet,
+                                     phiebfab,
+                                     is_eb_inhomog, dxinvarr,
+                                     ascalar, bscalar, ncomp, beta_on_centroid, phi_on_centroid);
+               });
+            } else if (treat_phi_as_on_centroid) {
+               Array4<Real const> const& bafab = barea->const_array(mfi);
+               Array4<Real const> const& bcfab = bcent->const_array(mfi);
+               Array4<Real const> const& ccfab = ccent->const_array(mfi);
                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
                {
                    mlebabeclap_adotx_centroid(tbx, yfab, xfab, afab, AMREX_D_DECL(bxfab,byfab,bzfab),
@@ -124,6 +151,8 @@ MLEBABecLap::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& in) c
                                      ascalar, bscalar, ncomp);
                });
             } else {
+               Array4<Real const> const& bafab = barea->const_array(mfi);
+               Array4<Real const> const& bcfab = bcent->const_array(mfi);
                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
                {
                    mlebabeclap_adotx(tbx, yfab, xfab, afab, AMREX_D_DECL(bxfab,byfab,bzfab),
@@ -192,8 +221,9 @@ MLEBABecLap::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
         : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
     auto fcent = (factory) ? factory->getFaceCent()
         : Array<const MultiCutFab*,AMREX_SPACEDIM>{AMREX_D_DECL(nullptr,nullptr,nullptr)};
-    const MultiCutFab* barea = (factory) ? &(factory->getBndryArea()) : nullptr;
-    const MultiCutFab* bcent = (factory) ? &(factory->getBndryCent()) : nullptr;
+    const EBCutCellData* cutcells = (factory) ? factory->getCutCellData() : nullptr;
+    const MultiCutFab* barea = (factory && !cutcells) ? &(factory->getBndryArea()) : nullptr;
+    const MultiCutFab* bcent = (factory && !cutcells) ? &(factory->getBndryCent()) : nullptr;
 
     bool is_eb_dirichlet =  isEBDirichlet();
 
@@ -271,8 +301,6 @@ MLEBABecLap::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
             AMREX_D_TERM(Array4<Real const> const& fcxfab = fcent[0]->const_array(mfi);,
                          Array4<Real const> const& fcyfab = fcent[1]->const_array(mfi);,
                          Array4<Real const> const& fczfab = fcent[2]->const_array(mfi););
-            Array4<Real const> const& bafab = barea->const_array(mfi);
-            Array4<Real const> const& bcfab = bcent->const_array(mfi);
             Array4<Real const> const& bebfab = (is_eb_dirichlet)
                 ? m_eb_b_coeffs[amrlev][mglev]->const_array(mfi) : foo;
 
@@ -281,22 +309,60 @@ MLEBABecLap::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
 
             if (phi_on_centroid) amrex::Abort("phi_on_centroid is still a WIP");
 
-            AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( vbx, thread_box,
-            {
-                mlebabeclap_gsrb(thread_box, solnfab, rhsfab, alpha, afab,
-                                 AMREX_D_DECL(dhx, dhy, dhz),
-                                 AMREX_D_DECL(bxfab,byfab,bzfab),
-                                 AMREX_D_DECL(m0,m2,m4),
-                                 AMREX_D_DECL(m1,m3,m5),
-                                 AMREX_D_DECL(f0fab,f2fab,f4fab),
-                                 AMREX_D_DECL(f1fab,f3fab,f5fab),
-                                 ccmfab, flagfab, vfracfab,
-                                 AMREX_D_DECL(apxfab,apyfab,apzfab),
-                                 AMREX_D_DECL(fcxfab,fcyfab,fczfab),
-                                 bafab, bcfab, bebfab,
-                                 is_eb_dirichlet, beta_on_centroid, phi_on_centroid,
-                                 vbx, redblack, nc);
-            });
+            if (m_cut_stencil[amrlev][mglev]) {
+                MLEBCutCellStencil const sten = getCutCellStencil(amrlev, mglev, mfi);
+                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( vbx, thread_box,
+                {
+                    mlebabeclap_gsrb_stencil(thread_box, solnfab, rhsfab, alpha, afab,
+                                             AMREX_D_DECL(dhx, dhy, dhz),
+                                             AMREX_D_DECL(bxfab,byfab,bzfab),
+                                             AMREX_D_DECL(m0,m2,m4),
+                                             AMREX_D_DECL(m1,m3,m5),
+                                             AMREX_D_DECL(f0fab,f2fab,f4fab),
+                                             AMREX_D_DECL(f1fab,f3fab,f5fab),
+                                             flagfab, vfracfab,
+                                             AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                             sten, vbx, redblack, nc);
+                });
+            } else if (cutcells) {
+                CutCellConstArray4 const& bafab = cutcells->const_array(mfi, EBCutCellData::BndryArea);
+                CutCellConstArray4 const& bcfab = cutcells->const_array(mfi, EBCutCellData::BndryCent);
+                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( vbx, thread_box,
+                {
+                    mlebabeclap_gsrb(thread_box, solnfab, rhsfab, alpha, afab,
+                                     AMREX_D_DECL(dhx, dhy, dhz),
+                                     AMREX_D_DECL(bxfab,byfab,bzfab),
+                                     AMREX_D_DECL(m0,m2,m4),
+                                     AMREX_D_DECL(m1,m3,m5),
+                                     AMREX_D_DECL(f0fab,f2fab,f4fab),
+                                     AMREX_D_DECL(f1fab,f3fab,f5fab),
+                                     ccmfab, flagfab, vfracfab,
+                                     AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                     AMREX_D_DECL(fcxfab,fcyfab,fczfab),
+                                     bafab, bcfab, bebfab,
+                                     is_eb_dirichlet, beta_on_centroid, phi_on_centroid,
+                                     vbx, redblack, nc);
+                });
+            } else {
+                Array4<Real const> const& bafab = barea->const_array(mfi);
+                Array4<Real const> const& bcfab = bcent->const_array(mfi);
+                AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( vbx, thread_box,
+                {
+                    mlebabeclap_gsrb(thread_box, solnfab, rhsfab, alpha, afab,
+                                     AMREX_D_DECL(dhx, dhy, dhz),
+                                     AMREX_D_DECL(bxfab,byfab,bzfab),
+                                     AMREX_D_DECL(m0,m2,m4),
+                                     AMREX_D_DECL(m1,m3,m5),
+                                     AMREX_D_DECL(f0fab,f2fab,f4fab),
+                                     AMREX_D_DECL(f1fab,f3fab,f5fab),
+                                     ccmfab, flagfab, vfracfab,
+                                     AMREX_D_DECL(apxfab,apyfab,apzfab),
+                                     AMREX_D_DECL(fcxfab,fcyfab,fczfab),
+                                     bafab, bcfab, bebfab,
+                                     is_eb_dirichlet, beta_on_centroid, phi_on_centroid,
+                                     vbx, redblack, nc);
+                });
+            }
         }
     }
 }
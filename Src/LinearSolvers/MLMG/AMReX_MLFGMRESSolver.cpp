@@ -0,0 +1,424 @@
+
+#include <AMReX_MLFGMRESSolver.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelReduce.H>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace amrex {
+
+MLFGMRESSolver::MLFGMRESSolver (MLMG& a_mlmg, MLLinOp& a_lp, const std::string& a_pp_prefix)
+    : mlmg(a_mlmg), Lp(a_lp)
+{
+    ParmParse pp(a_pp_prefix);
+
+    std::string type;
+    if (pp.query("type", type)) {
+        if (type == "fgmres") {
+            m_type = Type::FGMRES;
+        } else if (type == "gcr") {
+            m_type = Type::GCR;
+        } else {
+            amrex::Abort("MLFGMRESSolver: unknown type " + type);
+        }
+    }
+    pp.query("verbose", m_verbose);
+    pp.query("max_iter", m_maxiter);
+    pp.query("restart", m_restart);
+    pp.query("precond_iter", m_precond_iter);
+    pp.query("tol_rel", m_tol_rel);
+    pp.query("tol_abs", m_tol_abs);
+}
+
+MLFGMRESSolver::~MLFGMRESSolver () {}
+
+Real
+MLFGMRESSolver::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs)
+{
+    return solve(a_sol, a_rhs, m_tol_rel, m_tol_abs);
+}
+
+Real
+MLFGMRESSolver::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs,
+                       Real a_tol_rel, Real a_tol_abs)
+{
+    BL_PROFILE("MLFGMRESSolver::solve()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(Lp.isCellCentered(),
+                                     "MLFGMRESSolver only supports cell-centered operators");
+    AMREX_ALWAYS_ASSERT(m_restart > 0 && m_precond_iter > 0);
+
+    m_nlevs = Lp.NAMRLevels();
+    m_ncomp = Lp.getNComp();
+
+    bool same_grids = static_cast<int>(m_ba.size()) == m_nlevs;
+    for (int lev = 0; lev < m_nlevs && same_grids; ++lev) {
+        same_grids = m_ba[lev] == a_rhs[lev]->boxArray()
+            && m_dm[lev] == a_rhs[lev]->DistributionMap();
+    }
+    if (!same_grids)
+    {
+        m_ba.resize(m_nlevs);
+        m_dm.resize(m_nlevs);
+        m_fine_mask.clear();
+        m_fine_mask.resize(m_nlevs);
+        for (int lev = 0; lev < m_nlevs; ++lev) {
+            m_ba[lev] = a_rhs[lev]->boxArray();
+            m_dm[lev] = a_rhs[lev]->DistributionMap();
+        }
+        for (int lev = 0; lev < m_nlevs-1; ++lev) {
+            m_fine_mask[lev] = std::make_unique<iMultiFab>
+                (makeFineMask(*a_rhs[lev], *a_rhs[lev+1], IntVect(0),
+                              IntVect(Lp.AMRRefRatio(lev)), Periodicity::NonPeriodic(), 1, 0));
+        }
+        define(m_l0, 0);
+        define(m_tmp, 0);
+    }
+
+    // The Krylov iteration needs the operator with homogeneous boundary conditions,
+    // L(z) - L(0).
+    {
+        MFVec zero;
+        define(zero, 1);
+        mlmg.apply(GetVecOfPtrs(m_l0), GetVecOfPtrs(zero));
+    }
+
+    if (m_type == Type::GCR) {
+        return solve_gcr(a_sol, a_rhs, a_tol_rel, a_tol_abs);
+    } else {
+        return solve_fgmres(a_sol, a_rhs, a_tol_rel, a_tol_abs);
+    }
+}
+
+Real
+MLFGMRESSolver::solve_fgmres (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs,
+                              Real a_tol_rel, Real a_tol_abs)
+{
+    const int m = m_restart;
+
+    Vector<MFVec> V(m+1);
+    Vector<MFVec> Z(m);
+    for (auto& v : V) define(v, 0);
+    for (auto& z : Z) define(z, 1);
+    MFVec w;
+    define(w, 0);
+
+    Vector<Real> R(m*m, 0.0);  // upper triangular factor of the Hessenberg matrix, R(i,j) = R[i*m+j]
+    Vector<Real> cs(m), sn(m), g(m+1), y(m), h, h2;
+    Vector<MFVec const*> vptr;
+
+    for (int lev = 0; lev < m_nlevs; ++lev) {
+        MultiFab::Copy(w[lev], *a_rhs[lev], 0, 0, m_ncomp, 0);
+    }
+    const Real bnorm = norm2(w);
+    Real resnorm = residual(V[0], a_sol, a_rhs);
+    const Real resnorm0 = resnorm;
+
+    const bool use_bnorm = bnorm >= resnorm0;
+    const Real max_norm = use_bnorm ? bnorm : resnorm0;
+    const std::string norm_name = use_bnorm ? "bnorm" : "resid0";
+    const Real res_target = std::max(a_tol_abs, std::max(a_tol_rel,Real(1.e-16))*max_norm);
+
+    if (m_verbose >= 1) {
+        amrex::Print() << "MLFGMRESSolver: Initial rhs               = " << bnorm << "\n"
+                       << "MLFGMRESSolver: Initial residual (resid0) = " << resnorm0 << "\n";
+    }
+
+    m_iter = 0;
+    while (resnorm > res_target && m_iter < m_maxiter)
+    {
+        scale(V[0], Real(1.0)/resnorm);
+        std::fill(g.begin(), g.end(), Real(0.0));
+        g[0] = resnorm;
+
+        int k = 0;
+        while (k < m && m_iter < m_maxiter)
+        {
+            precond(Z[k], V[k]);
+            apply(w, Z[k]);
+
+            // Classical Gram-Schmidt with one reorthogonalization.  The norm of the
+            // new vector is reduced together with the inner products of the second
+            // pass, and corrected for them.
+            vptr.resize(k+1);
+            for (int i = 0; i <= k; ++i) vptr[i] = &V[i];
+            dots(h, vptr, w);
+            for (int i = 0; i <= k; ++i) saxpy(w, -h[i], V[i]);
+            dots(h2, vptr, w, true);
+            Real ww = h2[k+1];
+            for (int i = 0; i <= k; ++i) {
+                saxpy(w, -h2[i], V[i]);
+                h[i] += h2[i];
+                ww -= h2[i]*h2[i];
+            }
+            const Real hnext = std::sqrt(std::max(ww, Real(0.0)));
+
+            // Apply the previous Givens rotations to the new column, and compute a new
+            // one that eliminates hnext.
+            for (int i = 0; i < k; ++i) {
+                const Real t = cs[i]*h[i] + sn[i]*h[i+1];
+                h[i+1] = -sn[i]*h[i] + cs[i]*h[i+1];
+                h[i] = t;
+            }
+            const Real rr = std::sqrt(h[k]*h[k] + hnext*hnext);
+            cs[k] = h[k] / rr;
+            sn[k] = hnext / rr;
+            h[k] = rr;
+            g[k+1] = -sn[k]*g[k];
+            g[k] = cs[k]*g[k];
+            for (int i = 0; i <= k; ++i) R[i*m+k] = h[i];
+
+            ++k;
+            ++m_iter;
+            resnorm = std::abs(g[k]);
+
+            if (m_verbose >= 2) {
+                amrex::Print() << "MLFGMRESSolver: Iteration " << std::setw(4) << m_iter
+                               << " resid/" << norm_name << " = " << resnorm/max_norm << "\n";
+            }
+
+            if (resnorm <= res_target || hnext <= Real(0.0)) break;
+
+            copy(V[k], w);
+            scale(V[k], Real(1.0)/hnext);
+        }
+
+        // Solve R y = g, and update the solution with the preconditioned vectors.
+        for (int i = k-1; i >= 0; --i) {
+            Real t = g[i];
+            for (int j = i+1; j < k; ++j) {
+                t -= R[i*m+j]*y[j];
+            }
+            y[i] = t / R[i*m+i];
+        }
+        for (int i = 0; i < k; ++i) {
+            for (int lev = 0; lev < m_nlevs; ++lev) {
+                MultiFab::Saxpy(*a_sol[lev], y[i], Z[i][lev], 0, 0, m_ncomp, 0);
+            }
+        }
+
+        // The true residual, which is also the first vector after a restart
+        resnorm = residual(V[0], a_sol, a_rhs);
+    }
+
+    if (resnorm > res_target) {
+        if (m_verbose > 0) {
+            amrex::Print() << "MLFGMRESSolver: Failed to converge after " << m_iter << " iterations."
+                           << " resid, resid/" << norm_name << " = "
+                           << resnorm << ", " << resnorm/max_norm << "\n";
+        }
+        amrex::Abort("MLFGMRESSolver failed");
+    } else if (m_verbose >= 1) {
+        amrex::Print() << "MLFGMRESSolver: Final Iter. " << m_iter
+                       << " resid, resid/" << norm_name << " = "
+                       << resnorm << ", " << resnorm/max_norm << "\n";
+    }
+
+    return resnorm;
+}
+
+Real
+MLFGMRESSolver::solve_gcr (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs,
+                           Real a_tol_rel, Real a_tol_abs)
+{
+    const int m = m_restart;
+
+    Vector<MFVec> Z(m);
+    Vector<MFVec> W(m);
+    for (auto& z : Z) define(z, 1);
+    for (auto& w : W) define(w, 0);
+    MFVec r;
+    define(r, 0);
+
+    Vector<Real> d;
+    Vector<MFVec const*> xptr;
+
+    for (int lev = 0; lev < m_nlevs; ++lev) {
+        MultiFab::Copy(r[lev], *a_rhs[lev], 0, 0, m_ncomp, 0);
+    }
+    const Real bnorm = norm2(r);
+    Real resnorm = residual(r, a_sol, a_rhs);
+    const Real resnorm0 = resnorm;
+
+    const bool use_bnorm = bnorm >= resnorm0;
+    const Real max_norm = use_bnorm ? bnorm : resnorm0;
+    const std::string norm_name = use_bnorm ? "bnorm" : "resid0";
+    const Real res_target = std::max(a_tol_abs, std::max(a_tol_rel,Real(1.e-16))*max_norm);
+
+    if (m_verbose >= 1) {
+        amrex::Print() << "MLFGMRESSolver: Initial rhs               = " << bnorm << "\n"
+                       << "MLFGMRESSolver: Initial residual (resid0) = " << resnorm0 << "\n";
+    }
+
+    m_iter = 0;
+    while (resnorm > res_target && m_iter < m_maxiter)
+    {
+        for (int k = 0; k < m && m_iter < m_maxiter; ++k)
+        {
+            precond(Z[k], r);
+            apply(W[k], Z[k]);
+
+            // The inner products with the previous (orthonormal) W's, with r and with
+            // itself are reduced together.  Because r is orthogonal to the previous W's,
+            // (r,W_k) does not change with the orthogonalization, and the norm is
+            // corrected for it.
+            xptr.resize(k+1);
+            for (int i = 0; i < k; ++i) xptr[i] = &W[i];
+            xptr[k] = &r;
+            dots(d, xptr, W[k], true);
+            Real ww = d[k+1];
+            for (int i = 0; i < k; ++i) {
+                saxpy(W[k], -d[i], W[i]);
+                saxpy(Z[k], -d[i], Z[i]);
+                ww -= d[i]*d[i];
+            }
+            if (ww <= Real(1.e-4)*d[k+1]) {
+                // too much cancellation
+                ww = norm2(W[k]);
+                ww *= ww;
+            }
+            const Real nrm = std::sqrt(ww);
+            if (nrm <= Real(0.0)) break;
+
+            scale(W[k], Real(1.0)/nrm);
+            scale(Z[k], Real(1.0)/nrm);
+            const Real alpha = d[k]/nrm;
+            for (int lev = 0; lev < m_nlevs; ++lev) {
+                MultiFab::Saxpy(*a_sol[lev], alpha, Z[k][lev], 0, 0, m_ncomp, 0);
+            }
+            saxpy(r, -alpha, W[k]);
+            resnorm = std::sqrt(std::max(resnorm*resnorm - alpha*alpha, Real(0.0)));
+
+            ++m_iter;
+
+            if (m_verbose >= 2) {
+                amrex::Print() << "MLFGMRESSolver: Iteration " << std::setw(4) << m_iter
+                               << " resid/" << norm_name << " = " << resnorm/max_norm << "\n";
+            }
+
+            if (resnorm <= res_target) break;
+        }
+
+        resnorm = residual(r, a_sol, a_rhs);
+    }
+
+    if (resnorm > res_target) {
+        if (m_verbose > 0) {
+            amrex::Print() << "MLFGMRESSolver: Failed to converge after " << m_iter << " iterations."
+                           << " resid, resid/" << norm_name << " = "
+                           << resnorm << ", " << resnorm/max_norm << "\n";
+        }
+        amrex::Abort("MLFGMRESSolver failed");
+    } else if (m_verbose >= 1) {
+        amrex::Print() << "MLFGMRESSolver: Final Iter. " << m_iter
+                       << " resid, resid/" << norm_name << " = "
+                       << resnorm << ", " << resnorm/max_norm << "\n";
+    }
+
+    return resnorm;
+}
+
+void
+MLFGMRESSolver::define (MFVec& v, int ng) const
+{
+    v.resize(m_nlevs);
+    for (int lev = 0; lev < m_nlevs; ++lev) {
+        v[lev].define(m_ba[lev], m_dm[lev], m_ncomp, ng, MFInfo(), *Lp.Factory(lev));
+        v[lev].setVal(0.0);
+    }
+}
+
+void
+MLFGMRESSolver::precond (MFVec& z, const MFVec& v)
+{
+    BL_PROFILE("MLFGMRESSolver::precond()");
+
+    // MLMG solves L(z) = rhs with the inhomogeneous boundary conditions, so
+    // L(z) - L(0) = v needs rhs = v + L(0).
+    for (int lev = 0; lev < m_nlevs; ++lev) {
+        MultiFab::LinComb(m_tmp[lev], Real(1.0), v[lev], 0, Real(1.0), m_l0[lev], 0, 0, m_ncomp, 0);
+    }
+    mlmg.precond(GetVecOfPtrs(z), GetVecOfConstPtrs(m_tmp), m_precond_iter);
+}
+
+void
+MLFGMRESSolver::apply (MFVec& w, MFVec& z)
+{
+    BL_PROFILE("MLFGMRESSolver::apply()");
+
+    mlmg.apply(GetVecOfPtrs(w), GetVecOfPtrs(z));
+    for (int lev = 0; lev < m_nlevs; ++lev) {
+        MultiFab::Subtract(w[lev], m_l0[lev], 0, 0, m_ncomp, 0);
+    }
+}
+
+Real
+MLFGMRESSolver::residual (MFVec& r, const Vector<MultiFab*>& a_sol,
+                          const Vector<MultiFab const*>& a_rhs)
+{
+    mlmg.compResidual(GetVecOfPtrs(r), a_sol, a_rhs);
+    return norm2(r);
+}
+
+void
+MLFGMRESSolver::dots (Vector<Real>& result, Vector<MFVec const*> const& x, const MFVec& y,
+                      bool with_yy) const
+{
+    BL_PROFILE("MLFGMRESSolver::dots()");
+
+    const int n = static_cast<int>(x.size());
+    result.assign(with_yy ? n+1 : n, 0.0);
+    for (int lev = 0; lev < m_nlevs; ++lev) {
+        const iMultiFab* mask = m_fine_mask[lev].get();
+        for (int i = 0; i < n; ++i) {
+            result[i] += mask
+                ? MultiFab::Dot(*mask, (*x[i])[lev], 0, y[lev], 0, m_ncomp, 0, true)
+                : MultiFab::Dot((*x[i])[lev], 0, y[lev], 0, m_ncomp, 0, true);
+        }
+        if (with_yy) {
+            result[n] += mask
+                ? MultiFab::Dot(*mask, y[lev], 0, y[lev], 0, m_ncomp, 0, true)
+                : MultiFab::Dot(y[lev], 0, m_ncomp, 0, true);
+        }
+    }
+    ParallelAllReduce::Sum(result.data(), static_cast<int>(result.size()),
+                           ParallelContext::CommunicatorSub());
+}
+
+Real
+MLFGMRESSolver::norm2 (const MFVec& x) const
+{
+    Vector<Real> r;
+    dots(r, {}, x, true);
+    return std::sqrt(r[0]);
+}
+
+void
+MLFGMRESSolver::saxpy (MFVec& y, Real a, const MFVec& x)
+{
+    for (int lev = 0; lev < static_cast<int>(y.size()); ++lev) {
+        MultiFab::Saxpy(y[lev], a, x[lev], 0, 0, y[lev].nComp(), 0);
+    }
+}
+
+void
+MLFGMRESSolver::scale (MFVec& x, Real a)
+{
+    for (auto& mf : x) {
+        mf.mult(a, 0, mf.nComp(), 0);
+    }
+}
+
+void
+MLFGMRESSolver::copy (MFVec& dst, const MFVec& src)
+{
+    for (int lev = 0; lev < static_cast<int>(dst.size()); ++lev) {
+        MultiFab::Copy(dst[lev], src[lev], 0, 0, dst[lev].nComp(), 0);
+    }
+}
+
+}
@@ -1016,6 +1016,202 @@ MLLinOp::resizeMultiGrid (int new_size)
     }
 }
 
+void
+MLLinOp::chebyshevSmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                          int niters) const
+{
+    BL_PROFILE("MLLinOp::chebyshevSmooth()");
+
+    chebyshevSetup(amrlev, mglev, sol);
+
+    const MultiFab& dinv = *m_cheby_dinv[amrlev][mglev];
+    const int ncomp = getNComp();
+    const int degree = niters * std::max(info.chebyshev_degree, 1);
+
+    // Damp the eigenmodes in [0.1,1.1]*lambda_max, the upper part of the
+    // spectrum of D^{-1}A.  The rest is left to the coarser levels.
+    const Real lambda = m_cheby_lambda[amrlev][mglev];
+    const Real lmax = Real(1.1)*lambda;
+    const Real lmin = Real(0.1)*lambda;
+    const Real theta = Real(0.5)*(lmax+lmin);
+    const Real delta = Real(0.5)*(lmax-lmin);
+    const Real sigma = theta/delta;
+    Real rho = Real(1.0)/sigma;
+
+    MultiFab r(sol.boxArray(), sol.DistributionMap(), ncomp, 0, MFInfo(), *Factory(amrlev,mglev));
+    MultiFab d(sol.boxArray(), sol.DistributionMap(), ncomp, 0, MFInfo(), *Factory(amrlev,mglev));
+
+    // r = D^{-1} (rhs - A sol)
+    auto jacobi_residual = [&] ()
+    {
+        apply(amrlev, mglev, r, sol, BCMode::Homogeneous, StateMode::Correction);
+        MultiFab::Xpay(r, Real(-1.0), rhs, 0, 0, ncomp, 0);
+        MultiFab::Multiply(r, dinv, 0, 0, ncomp, 0);
+    };
+
+    jacobi_residual();
+    MultiFab::Copy(d, r, 0, 0, ncomp, 0);
+    d.mult(Real(1.0)/theta, 0, ncomp, 0);
+
+    for (int it = 0; it < degree; ++it)
+    {
+        MultiFab::Add(sol, d, 0, 0, ncomp, 0);
+        if (it+1 == degree) break;
+
+        jacobi_residual();
+        const Real rho_new = Real(1.0)/(Real(2.0)*sigma - rho);
+        MultiFab::LinComb(d, rho_new*rho, d, 0, Real(2.0)*rho_new/delta, r, 0, 0, ncomp, 0);
+        rho = rho_new;
+    }
+}
+
+void
+MLLinOp::chebyshevSetup (int amrlev, int mglev, const MultiFab& sol) const
+{
+    if (m_cheby_dinv.empty()) {
+        m_cheby_dinv.resize(m_num_amr_levels);
+        m_cheby_lambda.resize(m_num_amr_levels);
+        for (int alev = 0; alev < m_num_amr_levels; ++alev) {
+            m_cheby_dinv[alev].resize(m_num_mg_levels[alev]);
+            m_cheby_lambda[alev].resize(m_num_mg_levels[alev], Real(0.0));
+        }
+    }
+
+    auto& dinv = m_cheby_dinv[amrlev][mglev];
+    if (dinv && dinv->boxArray() == sol.boxArray()
+        && dinv->DistributionMap() == sol.DistributionMap()) {
+        return;
+    }
+
+    BL_PROFILE("MLLinOp::chebyshevSetup()");
+
+    const int ncomp = getNComp();
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    MultiFab v(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), *Factory(amrlev,mglev));
+    MultiFab Av(ba, dm, ncomp, 0, MFInfo(), *Factory(amrlev,mglev));
+    dinv = std::make_unique<MultiFab>(ba, dm, ncomp, 0, MFInfo(), *Factory(amrlev,mglev));
+
+    // Probe the diagonal with unit vectors on every third cell (or node) in each
+    // direction.  No stencil reaches beyond the nearest neighbors, so A applied to
+    // a probe gives the diagonal on the probed cells.  In a periodic direction, the
+    // period is chosen so that the two cells next to the periodic boundary have
+    // different colors.  For nodal data, the nodes on the two periodic boundaries
+    // are the same node and must have the same color, so the period has to
+    // divide the number of cells.
+    const Geometry& geom = m_geom[amrlev][mglev];
+    GpuArray<int,3> per{{3,3,3}};
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        const int len = geom.Domain().length(idim);
+        if (geom.isPeriodic(idim)) {
+            if (sol.ixType().nodeCentered(idim)) {
+                per[idim] = std::min(per[idim], len);
+                while (len % per[idim] != 0) { ++per[idim]; }
+            } else {
+                while (len > 1 && len % per[idim] == 1) { ++per[idim]; }
+            }
+        }
+    }
+    const int ncolors = AMREX_D_TERM(per[0], *per[1], *per[2]);
+
+    auto color_of = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> int
+    {
+        const int ci = (i % per[0] + per[0]) % per[0];
+        const int cj = (j % per[1] + per[1]) % per[1];
+        const int ck = (k % per[2] + per[2]) % per[2];
+        return ci + per[0]*(cj + per[1]*ck);
+    };
+
+    for (int n = 0; n < ncomp; ++n) {
+        for (int color = 0; color < ncolors; ++color)
+        {
+            v.setVal(0.0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(v,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+                Array4<Real> const& a = v.array(mfi);
+                AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+                {
+                    if (color_of(i,j,k) == color) { a(i,j,k,n) = 1.0; }
+                });
+            }
+
+            apply(amrlev, mglev, Av, v, BCMode::Homogeneous, StateMode::Correction);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(*dinv,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+                Array4<Real> const& di = dinv->array(mfi);
+                Array4<Real const> const& av = Av.const_array(mfi);
+                AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+                {
+                    if (color_of(i,j,k) == color) {
+                        // zero for covered cells and Dirichlet nodes, which are not updated
+                        di(i,j,k,n) = (av(i,j,k,n) != 0.0) ? Real(1.0)/av(i,j,k,n) : Real(0.0);
+                    }
+                });
+            }
+        }
+    }
+
+    // Power iterations for the largest eigenvalue of D^{-1}A, starting from an
+    // oscillatory pseudo-random vector that does not depend on the decomposition.
+    v.setVal(0.0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(v,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& a = v.array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D(bx, ncomp, i, j, k, n,
+        {
+            unsigned int h = static_cast<unsigned int>(i)*73856093u
+                ^ static_cast<unsigned int>(j)*19349663u
+                ^ static_cast<unsigned int>(k)*83492791u
+                ^ static_cast<unsigned int>(n)*2654435761u;
+            h ^= h >> 13;
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+            const Real s = ((i+j+k) % 2 == 0) ? Real(1.0) : Real(-1.0);
+            a(i,j,k,n) = s * (Real(0.5) + Real(h & 0xffffu) / Real(0xffff));
+        });
+    }
+    MultiFab::Multiply(v, *dinv, 0, 0, ncomp, 0); // drop the cells that are not updated
+
+    Real lambda = 0.0;
+    Real vnorm = std::sqrt(MultiFab::Dot(v, 0, v, 0, ncomp, 0));
+    constexpr int npower = 10;
+    for (int it = 0; it < npower && vnorm > 0.0; ++it)
+    {
+        apply(amrlev, mglev, Av, v, BCMode::Homogeneous, StateMode::Correction);
+        MultiFab::Multiply(Av, *dinv, 0, 0, ncomp, 0);
+        const Real avnorm = std::sqrt(MultiFab::Dot(Av, 0, Av, 0, ncomp, 0));
+        lambda = avnorm / vnorm;
+        MultiFab::Copy(v, Av, 0, 0, ncomp, 0);
+        vnorm = avnorm;
+    }
+    m_cheby_lambda[amrlev][mglev] = (lambda > 0.0) ? lambda : Real(1.0);
+
+    if (verbose >= 2) {
+        amrex::Print() << "MLLinOp: Chebyshev smoother on AMR level " << amrlev << " MG level "
+                       << mglev << ": lambda_max(D^-1 A) ~ " << lambda << "\n";
+    }
+}
+
+void
+MLLinOp::resetChebyshev () const
+{
+    m_cheby_dinv.clear();
+    m_cheby_lambda.clear();
+}
+
 #ifdef AMREX_USE_PETSC
 std::unique_ptr<PETScABecLap>
 MLLinOp::makePETSc () const
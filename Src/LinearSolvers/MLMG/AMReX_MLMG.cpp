@@ -10,6 +10,11 @@
 #include <AMReX_PETSc.H>
 #endif
 
+#ifdef AMREX_USE_SWFFT
+#include <AMReX_MLPoisson.H>
+#include <AMReX_FFTPoisson.H>
+#endif
+
 #ifdef AMREX_USE_EB
 #include <AMReX_EBFArrayBox.H>
 #include <AMReX_EBFabFactory.H>
@@ -39,6 +44,29 @@
 
 namespace amrex {
 
+namespace {
+    // Copy the valid cells of src into dst, converting between precisions
+    template <class DFAB, class SFAB>
+    void copyConvert (FabArray<DFAB>& dst, FabArray<SFAB> const& src, int ncomp)
+    {
+        using D = typename DFAB::value_type;
+        using S = typename SFAB::value_type;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            Array4<D> const& d = dst.array(mfi);
+            Array4<S const> const& s = src.const_array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+            {
+                d(i,j,k,n) = static_cast<D>(s(i,j,k,n));
+            });
+        }
+    }
+}
+
 MLMG::MLMG (MLLinOp& a_lp)
     : linop(a_lp),
       namrlevs(a_lp.NAMRLevels()),
@@ -58,18 +86,7 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         checkPoint(a_sol, a_rhs, a_tol_rel, a_tol_abs, checkpoint_file);
     }
 
-    if (bottom_solver == BottomSolver::Default) {
-        bottom_solver = linop.getDefaultBottomSolver();
-    }
-
-    if (bottom_solver == BottomSolver::hypre || bottom_solver == BottomSolver::petsc) {
-        int mo = linop.getMaxOrder();
-        if (a_sol[0]->hasEBFabFactory()) {
-            linop.setMaxOrder(2);
-        } else {
-            linop.setMaxOrder(std::min(3,mo));  // maxorder = 4 not supported
-        }
-    }
+    prepareBottomSolver(*a_sol[0]);
 
     bool is_nsolve = linop.m_parent;
 
@@ -81,16 +98,33 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     m_iter_fine_resnorm0.clear();
 
     prepareForSolve(a_sol, a_rhs);
+    timer[setup_time] += amrex::second() - solve_start_time;
 
     computeMLResidual(finest_amr_lev);
 
     int ncomp = linop.getNComp();
 
+    // With independent components, each component has its own convergence target.
+    const bool comp_conv = independent_comps && ncomp > 1;
+    Vector<Real> res_comp(comp_conv ? ncomp : 0);
+    Vector<Real> rhs_comp(comp_conv ? ncomp : 0);
+    Real* res_comp_p = comp_conv ? res_comp.data() : nullptr;
+
     bool local = true;
-    Real resnorm0 = MLResNormInf(finest_amr_lev, local);
-    Real rhsnorm0 = MLRhsNormInf(local);
+    Real resnorm0 = MLResNormInf(finest_amr_lev, local, res_comp_p);
+    Real rhsnorm0 = MLRhsNormInf(local, comp_conv ? rhs_comp.data() : nullptr);
     if (!is_nsolve) {
-        ParallelAllReduce::Max<Real>({resnorm0, rhsnorm0}, ParallelContext::CommunicatorSub());
+        if (comp_conv) {
+            Vector<Real> norms = res_comp;
+            norms.insert(norms.end(), rhs_comp.begin(), rhs_comp.end());
+            ParallelAllReduce::Max(norms.data(), 2*ncomp, ParallelContext::CommunicatorSub());
+            std::copy(norms.begin(), norms.begin()+ncomp, res_comp.begin());
+            std::copy(norms.begin()+ncomp, norms.end(), rhs_comp.begin());
+            resnorm0 = *std::max_element(res_comp.begin(), res_comp.end());
+            rhsnorm0 = *std::max_element(rhs_comp.begin(), rhs_comp.end());
+        } else {
+            ParallelAllReduce::Max<Real>({resnorm0, rhsnorm0}, ParallelContext::CommunicatorSub());
+        }
 
         if (verbose >= 1)
         {
@@ -113,7 +147,21 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     }
     const Real res_target = std::max(a_tol_abs, std::max(a_tol_rel,Real(1.e-16))*max_norm);
 
-    if (!is_nsolve && resnorm0 <= res_target) {
+    Vector<Real> res_target_comp(comp_conv ? ncomp : 0);
+    for (int n = 0; n < int(res_target_comp.size()); ++n) {
+        const Real max_norm_n = (always_use_bnorm || rhs_comp[n] >= res_comp[n])
+            ? rhs_comp[n] : res_comp[n];
+        res_target_comp[n] = std::max(a_tol_abs, std::max(a_tol_rel,Real(1.e-16))*max_norm_n);
+    }
+    auto num_converged_comps = [&] () -> int {
+        int nconv = 0;
+        for (int n = 0; n < int(res_target_comp.size()); ++n) {
+            if (res_comp[n] <= res_target_comp[n]) ++nconv;
+        }
+        return nconv;
+    };
+
+    if (!is_nsolve && (comp_conv ? num_converged_comps() == ncomp : resnorm0 <= res_target)) {
         composite_norminf = resnorm0;
         if (verbose >= 1) {
             amrex::Print() << "MLMG: No iterations needed\n";
@@ -134,27 +182,33 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
 
             if (is_nsolve) continue;
 
-            Real fine_norminf = ResNormInf(finest_amr_lev);
+            Real fine_norminf = ResNormInf(finest_amr_lev, false, res_comp_p);
             m_iter_fine_resnorm0.push_back(fine_norminf);
             composite_norminf = fine_norminf;
+            const int nconv = num_converged_comps();
             if (verbose >= 2) {
                 amrex::Print() << "MLMG: Iteration " << std::setw(3) << iter+1 << " Fine resid/"
-                               << norm_name << " = " << fine_norminf/max_norm << "\n";
+                               << norm_name << " = " << fine_norminf/max_norm;
+                if (comp_conv) {
+                    amrex::Print() << ", " << nconv << " of " << ncomp << " components converged";
+                }
+                amrex::Print() << "\n";
             }
-            bool fine_converged = (fine_norminf <= res_target);
+            bool fine_converged = comp_conv ? (nconv == ncomp) : (fine_norminf <= res_target);
 
             if (namrlevs == 1 && fine_converged) {
                 converged = true;
             } else if (fine_converged) {
                 // finest level is converged, but we still need to test the coarse levels
                 computeMLResidual(finest_amr_lev-1);
-                Real crse_norminf = MLResNormInf(finest_amr_lev-1);
+                Real crse_norminf = MLResNormInf(finest_amr_lev-1, false, res_comp_p);
                 if (verbose >= 2) {
                     amrex::Print() << "MLMG: Iteration " << std::setw(3) << iter+1
                                    << " Crse resid/" << norm_name << " = "
                                    << crse_norminf/max_norm << "\n";
                 }
-                converged = (crse_norminf <= res_target);
+                converged = comp_conv ? (num_converged_comps() == ncomp)
+                                      : (crse_norminf <= res_target);
                 composite_norminf = std::max(fine_norminf, crse_norminf);
             } else {
                 converged = false;
@@ -214,7 +268,8 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         {
             amrex::AllPrint() << "MLMG: Timers: Solve = " << timer[solve_time]
                               << " Iter = " << timer[iter_time]
-                              << " Bottom = " << timer[bottom_time] << "\n";
+                              << " Bottom = " << timer[bottom_time]
+                              << " Setup = " << timer[setup_time] << "\n";
         }
     }
 
@@ -223,6 +278,45 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     return composite_norminf;
 }
 
+void
+MLMG::precond (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs, int niters)
+{
+    BL_PROFILE("MLMG::precond()");
+
+    prepareBottomSolver(*a_sol[0]);
+
+    const int ncomp = linop.getNComp();
+    for (int alev = 0; alev < namrlevs; ++alev) {
+        a_sol[alev]->setVal(0.0);
+    }
+
+    // This is called once per Krylov iteration, so only report the hierarchy once.
+    const int old_verbose = verbose;
+    if (solve_called > 0) verbose = std::min(verbose, 1);
+    prepareForSolve(a_sol, a_rhs);
+    verbose = old_verbose;
+
+    computeMLResidual(finest_amr_lev);
+
+    for (int iter = 0; iter < niters; ++iter)
+    {
+        if (iter > 0) {
+            computeResidual(finest_amr_lev);
+        }
+        oneIter(iter);
+    }
+
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        if (a_sol[alev] != sol[alev])
+        {
+            MultiFab::Copy(*a_sol[alev], *sol[alev], 0, 0, ncomp, 0);
+        }
+    }
+
+    ++solve_called;
+}
+
 // in  : Residual (res) on the finest AMR level
 // out : sol on all AMR levels
 void MLMG::oneIter (int iter)
@@ -259,6 +353,8 @@ void MLMG::oneIter (int iter)
 
         if (iter < max_fmg_iters) {
             mgFcycle ();
+        } else if (use_float) {
+            mgVcycleFloat (0);
         } else {
             mgVcycle (0, 0);
         }
@@ -394,8 +490,12 @@ void
 MLMG::miniCycle (int amrlev)
 {
     BL_PROFILE("MLMG::miniCycle()");
-    const int mglev = 0;
-    mgVcycle(amrlev, mglev);
+    if (use_float) {
+        mgVcycleFloat(amrlev);
+    } else {
+        const int mglev = 0;
+        mgVcycle(amrlev, mglev);
+    }
 }
 
 // in   : Residual (res)
@@ -420,11 +520,8 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
 
         cor[amrlev][mglev]->setVal(0.0);
         bool skip_fillboundary = true;
-        for (int i = 0; i < nu1; ++i) {
-            linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
-                         skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothIters(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
+                          nu1, skip_fillboundary);
 
         // rescor = res - L(cor)
         computeResOfCorrection(amrlev, mglev);
@@ -470,11 +567,8 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
         }
         cor[amrlev][mglev_bottom]->setVal(0.0);
         bool skip_fillboundary = true;
-        for (int i = 0; i < nu1; ++i) {
-            linop.smooth(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom], res[amrlev][mglev_bottom],
-                         skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothIters(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom], res[amrlev][mglev_bottom],
+                          nu1, skip_fillboundary);
         if (verbose >= 4)
         {
             computeResOfCorrection(amrlev, mglev_bottom);
@@ -497,9 +591,7 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
             amrex::Print() << "AT LEVEL "  << amrlev << " " << mglev
                            << "   UP: Norm before smooth " << norm << "\n";
         }
-        for (int i = 0; i < nu2; ++i) {
-            linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev]);
-        }
+        linop.smoothIters(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev], nu2);
 
         if (cf_strategy == CFStrategy::ghostnodes) computeResOfCorrection(amrlev, mglev);
 
@@ -513,6 +605,77 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
     }
 }
 
+// V-cycle with single-precision smoothing, restriction and interpolation
+// in   : Residual (res) on MG level 0
+// out  : Correction (cor) on MG level 0
+void
+MLMG::mgVcycleFloat (int amrlev)
+{
+    BL_PROFILE("MLMG::mgVcycleFloat()");
+
+    const int mglev_bottom = linop.NMGLevels(amrlev) - 1;
+    const int ncomp = linop.getNComp();
+
+    if (amrlev == 0 && mglev_bottom == 0) {
+        // nothing to gain, the bottom solver does all the work
+        mgVcycle(amrlev, 0);
+        return;
+    }
+
+    copyConvert(res_f[amrlev][0], res[amrlev][0], ncomp);
+
+    for (int mglev = 0; mglev < mglev_bottom; ++mglev)
+    {
+        BL_PROFILE_VAR("MLMG::mgVcycleFloat_down::"+std::to_string(mglev), blp_mgv_down_lev);
+
+        cor_f[amrlev][mglev].setVal(0.f);
+        bool skip_fillboundary = true;
+        for (int i = 0; i < nu1; ++i) {
+            linop.smoothFloat(amrlev, mglev, cor_f[amrlev][mglev], res_f[amrlev][mglev],
+                              skip_fillboundary);
+            skip_fillboundary = false;
+        }
+
+        // rescor = res - L(cor)
+        linop.correctionResidualFloat(amrlev, mglev, rescor_f[amrlev][mglev],
+                                      cor_f[amrlev][mglev], res_f[amrlev][mglev]);
+
+        // res_crse = R(rescor_fine); this provides res/b to the level below
+        linop.restrictionFloat(amrlev, mglev+1, res_f[amrlev][mglev+1], rescor_f[amrlev][mglev]);
+    }
+
+    BL_PROFILE_VAR("MLMG::mgVcycleFloat_bottom", blp_bottom);
+    if (amrlev == 0)
+    {
+        copyConvert(res[amrlev][mglev_bottom], res_f[amrlev][mglev_bottom], ncomp);
+        bottomSolve();
+        copyConvert(cor_f[amrlev][mglev_bottom], *cor[amrlev][mglev_bottom], ncomp);
+    }
+    else
+    {
+        cor_f[amrlev][mglev_bottom].setVal(0.f);
+        bool skip_fillboundary = true;
+        for (int i = 0; i < nu1; ++i) {
+            linop.smoothFloat(amrlev, mglev_bottom, cor_f[amrlev][mglev_bottom],
+                              res_f[amrlev][mglev_bottom], skip_fillboundary);
+            skip_fillboundary = false;
+        }
+    }
+    BL_PROFILE_VAR_STOP(blp_bottom);
+
+    for (int mglev = mglev_bottom-1; mglev >= 0; --mglev)
+    {
+        BL_PROFILE_VAR("MLMG::mgVcycleFloat_up::"+std::to_string(mglev), blp_mgv_up_lev);
+        // cor_fine += I(cor_crse)
+        addInterpCorrectionFloat(amrlev, mglev);
+        for (int i = 0; i < nu2; ++i) {
+            linop.smoothFloat(amrlev, mglev, cor_f[amrlev][mglev], res_f[amrlev][mglev]);
+        }
+    }
+
+    copyConvert(*cor[amrlev][0], cor_f[amrlev][0], ncomp);
+}
+
 // FMG cycle on the coarsest AMR level.
 // in:  Residual on the top MG level (i.e., 0)
 // out: Correction (cor) on all MG levels
@@ -857,6 +1020,37 @@ MLMG::addInterpCorrection (int alev, int mglev)
     linop.interpolation(alev, mglev, fine_cor, *cmf);
 }
 
+void
+MLMG::addInterpCorrectionFloat (int alev, int mglev)
+{
+    BL_PROFILE("MLMG::addInterpCorrectionFloat()");
+
+    const int ncomp = linop.getNComp();
+
+    const MLLinOp::FloatMultiFab& crse_cor = cor_f[alev][mglev+1];
+    MLLinOp::FloatMultiFab&       fine_cor = cor_f[alev][mglev  ];
+
+    MLLinOp::FloatMultiFab cfine;
+    const MLLinOp::FloatMultiFab* cmf;
+
+    if (amrex::isMFIterSafe(crse_cor, fine_cor))
+    {
+        cmf = &crse_cor;
+    }
+    else
+    {
+        BoxArray cba = fine_cor.boxArray();
+        IntVect ratio = (alev > 0) ? IntVect(2) : linop.mg_coarsen_ratio_vec[mglev];
+
+        cba.coarsen(ratio);
+        cfine.define(cba, fine_cor.DistributionMap(), ncomp, 0);
+        cfine.ParallelCopy(crse_cor);
+        cmf = &cfine;
+    }
+
+    linop.interpolationFloat(alev, mglev, fine_cor, *cmf);
+}
+
 // Compute rescor = res - L(cor)
 // in   : res
 // inout: cor (out due to FillBoundary in linop.correctionResidual)
@@ -919,6 +1113,7 @@ MLMG::actualBottomSolve ()
     if (!linop.isBottomActive()) return;
 
     auto bottom_start_time = amrex::second();
+    const double setup_time_0 = timer[setup_time];
 
     ParallelContext::push(linop.BottomCommunicator());
 
@@ -932,10 +1127,7 @@ MLMG::actualBottomSolve ()
     if (bottom_solver == BottomSolver::smoother)
     {
         bool skip_fillboundary = true;
-        for (int i = 0; i < nuf; ++i) {
-            linop.smooth(amrlev, mglev, x, b, skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothIters(amrlev, mglev, x, b, nuf, skip_fillboundary);
     }
     else
     {
@@ -951,6 +1143,20 @@ MLMG::actualBottomSolve ()
             makeSolvable(amrlev,mglev,*bottom_b);
         }
 
+#if defined(AMREX_USE_SWFFT) && (AMREX_SPACEDIM == 3)
+        // SWFFT cannot split every domain over every number of ranks.
+        if (bottom_solver == BottomSolver::fft && fft_solver == nullptr &&
+            !FFTPoisson::isSupported(linop.m_geom[0].back()))
+        {
+            if (verbose > 0) {
+                amrex::Print() << "MLMG: SWFFT cannot decompose the bottom domain on "
+                               << ParallelContext::NProcsSub()
+                               << " ranks, switching the bottom solver to bicgstab\n";
+            }
+            bottom_solver = BottomSolver::bicgstab; // switch permanently
+        }
+#endif
+
         if (bottom_solver == BottomSolver::hypre)
         {
 #if defined(AMREX_USE_HYPRE) && (AMREX_SPACEDIM > 1)
@@ -961,12 +1167,33 @@ MLMG::actualBottomSolve ()
         {
             bottomSolveWithPETSc(x, *bottom_b);
         }
+        else if (bottom_solver == BottomSolver::fft)
+        {
+            bottomSolveWithFFT(x, *bottom_b);
+        }
+        else if (bottom_solver == BottomSolver::direct)
+        {
+            bottomSolveWithDirect(x, *bottom_b);
+        }
+        else if (bottom_solver == BottomSolver::amg)
+        {
+            int ret = bottomSolveWithAMG(x, *bottom_b);
+            if (ret != 0) {
+                cor[amrlev][mglev]->setVal(0.0);
+            }
+            const int n = (ret==0) ? nub : nuf;
+            linop.smoothIters(amrlev, mglev, x, b, n);
+        }
         else
         {
             MLCGSolver::Type cg_type;
             if (bottom_solver == BottomSolver::cg ||
                 bottom_solver == BottomSolver::cgbicg) {
                 cg_type = MLCGSolver::Type::CG;
+            } else if (bottom_solver == BottomSolver::pipelined_cg) {
+                cg_type = MLCGSolver::Type::PipelinedCG;
+            } else if (bottom_solver == BottomSolver::pipelined_bicgstab) {
+                cg_type = MLCGSolver::Type::PipelinedBiCGStab;
             } else {
                 cg_type = MLCGSolver::Type::BiCGStab;
             }
@@ -994,15 +1221,15 @@ MLMG::actualBottomSolve ()
                 }
             }
             const int n = (ret==0) ? nub : nuf;
-            for (int i = 0; i < n; ++i) {
-                linop.smooth(amrlev, mglev, x, b);
-            }
+            linop.smoothIters(amrlev, mglev, x, b, n);
         }
     }
 
     ParallelContext::pop();
 
-    timer[bottom_time] += amrex::second() - bottom_start_time;
+    // the setup of the bottom solver is counted as setup time
+    timer[bottom_time] += amrex::second() - bottom_start_time
+        - (timer[setup_time] - setup_time_0);
 }
 
 int
@@ -1010,6 +1237,7 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
 {
     MLCGSolver cg_solver(this, linop);
     cg_solver.setSolver(type);
+    cg_solver.setIndependentComponents(independent_comps);
     cg_solver.setVerbose(bottom_verbose);
     cg_solver.setMaxIter(bottom_maxiter);
     if (cf_strategy == CFStrategy::ghostnodes) cg_solver.setNGhost(linop.getNGrow());
@@ -1022,9 +1250,55 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
     return ret;
 }
 
+int
+MLMG::bottomSolveWithAMG (MultiFab& x, const MultiFab& b)
+{
+    auto setup_start_time = amrex::second();
+    if (amg_solver == nullptr)  // We should reuse the setup
+    {
+        amg_solver = std::make_unique<MLAMGSolver>(linop);
+        amg_solver->setVerbose(bottom_verbose);
+        amg_solver->setStrongThreshold(amg_strong_threshold);
+        amg_solver->setup();
+        amg_setup_age = 0;
+        amg_needs_update = false;
+    }
+    else if (amg_needs_update)
+    {
+        amg_solver->updateMatrix();
+        amg_needs_update = false;
+    }
+    timer[setup_time] += amrex::second() - setup_start_time;
+    amg_solver->setVerbose(bottom_verbose);
+    amg_solver->setMaxIter(bottom_maxiter);
+
+    int ret = amg_solver->solve(x, b, bottom_reltol, bottom_abstol);
+    if (ret != 0 && verbose > 1) {
+        amrex::Print() << "MLMG: Bottom solve failed.\n";
+    }
+    m_niters_cg.push_back(amg_solver->getNumIters());
+    return ret;
+}
+
+void
+MLMG::bottomSolveWithDirect (MultiFab& x, const MultiFab& b)
+{
+    auto setup_start_time = amrex::second();
+    if (direct_solver == nullptr)  // We should reuse the factorization
+    {
+        direct_solver = std::make_unique<MLDirectSolver>(linop);
+        direct_solver->setVerbose(bottom_verbose);
+        direct_solver->setup();
+    }
+    timer[setup_time] += amrex::second() - setup_start_time;
+
+    direct_solver->solve(x, b);
+    m_niters_cg.push_back(0);
+}
+
 // Compute single-level masked inf-norm of Residual (res).
 Real
-MLMG::ResNormInf (int alev, bool local)
+MLMG::ResNormInf (int alev, bool local, Real* comp_norm)
 {
     BL_PROFILE("MLMG::ResNormInf()");
     const int ncomp = linop.getNComp();
@@ -1055,31 +1329,53 @@ MLMG::ResNormInf (int alev, bool local)
             newnorm = pmf->norm0(n,0,true);
         }
         norm = std::max(norm, newnorm);
+        if (comp_norm) comp_norm[n] = newnorm;
+    }
+    if (!local) {
+        if (comp_norm) {
+            ParallelAllReduce::Max(comp_norm, ncomp, ParallelContext::CommunicatorSub());
+            norm = *std::max_element(comp_norm, comp_norm+ncomp);
+        } else {
+            ParallelAllReduce::Max(norm, ParallelContext::CommunicatorSub());
+        }
     }
-    if (!local) ParallelAllReduce::Max(norm, ParallelContext::CommunicatorSub());
     return norm;
 }
 
 // Computes multi-level masked inf-norm of Residual (res).
 Real
-MLMG::MLResNormInf (int alevmax, bool local)
+MLMG::MLResNormInf (int alevmax, bool local, Real* comp_norm)
 {
     BL_PROFILE("MLMG::MLResNormInf()");
+    const int ncomp = linop.getNComp();
+    Vector<Real> lev_norm(comp_norm ? ncomp : 0);
+    if (comp_norm) std::fill(comp_norm, comp_norm+ncomp, Real(0.0));
     Real r = 0.0;
     for (int alev = 0; alev <= alevmax; ++alev)
     {
-        r = std::max(r, ResNormInf(alev,true));
+        r = std::max(r, ResNormInf(alev, true, comp_norm ? lev_norm.data() : nullptr));
+        for (int n = 0; n < int(lev_norm.size()); ++n) {
+            comp_norm[n] = std::max(comp_norm[n], lev_norm[n]);
+        }
+    }
+    if (!local) {
+        if (comp_norm) {
+            ParallelAllReduce::Max(comp_norm, ncomp, ParallelContext::CommunicatorSub());
+            r = *std::max_element(comp_norm, comp_norm+ncomp);
+        } else {
+            ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
+        }
     }
-    if (!local) ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
     return r;
 }
 
 // Compute multi-level masked inf-norm of RHS (rhs).
 Real
-MLMG::MLRhsNormInf (bool local)
+MLMG::MLRhsNormInf (bool local, Real* comp_norm)
 {
     BL_PROFILE("MLMG::MLRhsNormInf()");
     const int ncomp = linop.getNComp();
+    if (comp_norm) std::fill(comp_norm, comp_norm+ncomp, Real(0.0));
     Real r = 0.0;
     for (int alev = 0; alev <= finest_amr_lev; ++alev)
     {
@@ -1101,14 +1397,24 @@ MLMG::MLRhsNormInf (bool local)
 #endif
         for (int n=0; n<ncomp; ++n)
         {
+            Real newnorm;
             if (alev < finest_amr_lev) {
-                r = std::max(r, pmf->norm0(*fine_mask[alev],n,0,true));
+                newnorm = pmf->norm0(*fine_mask[alev],n,0,true);
             } else {
-                r = std::max(r, pmf->norm0(n,0,true));
+                newnorm = pmf->norm0(n,0,true);
             }
+            r = std::max(r, newnorm);
+            if (comp_norm) comp_norm[n] = std::max(comp_norm[n], newnorm);
+        }
+    }
+    if (!local) {
+        if (comp_norm) {
+            ParallelAllReduce::Max(comp_norm, ncomp, ParallelContext::CommunicatorSub());
+            r = *std::max_element(comp_norm, comp_norm+ncomp);
+        } else {
+            ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
         }
     }
-    if (!local) ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
     return r;
 }
 
@@ -1138,26 +1444,36 @@ MLMG::buildFineMask ()
 }
 
 void
-MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs)
+MLMG::prepareBottomSolver (const MultiFab& a_sol)
 {
-    BL_PROFILE("MLMG::prepareForSolve()");
-
-    AMREX_ASSERT(namrlevs <= a_sol.size());
-    AMREX_ASSERT(namrlevs <= a_rhs.size());
-
-    timer.assign(ntimers, 0.0);
+    if (bottom_solver == BottomSolver::Default) {
+        bottom_solver = linop.getDefaultBottomSolver();
+    }
 
-    const int ncomp = linop.getNComp();
-    IntVect ng_rhs(0);
-    IntVect ng_sol(1);
-    if (linop.hasHiddenDimension()) ng_sol[linop.hiddenDirection()] = 0;
+    if (bottom_solver == BottomSolver::hypre || bottom_solver == BottomSolver::petsc ||
+        bottom_solver == BottomSolver::amg || bottom_solver == BottomSolver::direct) {
+        int mo = linop.getMaxOrder();
+        if (a_sol.hasEBFabFactory()) {
+            linop.setMaxOrder(2);
+        } else {
+            linop.setMaxOrder(std::min(3,mo));  // maxorder = 4 not supported
+        }
+    }
+}
 
+void
+MLMG::prepareLinOp ()
+{
     if (!linop_prepared) {
         linop.prepareForSolve();
         linop_prepared = true;
     } else if (linop.needsUpdate()) {
         linop.update();
+        linop.resetChebyshev();
 
+        // The hypre and PETSc solvers are rebuilt from scratch, including
+        // the sparsity pattern of their matrices, which does not change.
+        // Updating only the values of the IJ matrix is not implemented.
 #if defined(AMREX_USE_HYPRE) && (AMREX_SPACEDIM > 1)
         hypre_solver.reset();
         hypre_bndry.reset();
@@ -1168,7 +1484,33 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
         petsc_solver.reset();
         petsc_bndry.reset();
 #endif
+
+        if (amg_solver && amg_setup_age < amg_setup_reuse) {
+            ++amg_setup_age;
+            amg_needs_update = true;
+        } else {
+            amg_solver.reset();
+        }
+        direct_solver.reset();
     }
+}
+
+void
+MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs)
+{
+    BL_PROFILE("MLMG::prepareForSolve()");
+
+    AMREX_ASSERT(namrlevs <= a_sol.size());
+    AMREX_ASSERT(namrlevs <= a_rhs.size());
+
+    timer.assign(ntimers, 0.0);
+
+    const int ncomp = linop.getNComp();
+    IntVect ng_rhs(0);
+    IntVect ng_sol(1);
+    if (linop.hasHiddenDimension()) ng_sol[linop.hiddenDirection()] = 0;
+
+    prepareLinOp();
 
     sol.resize(namrlevs);
     sol_raii.resize(namrlevs);
@@ -1250,7 +1592,7 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
         }
     }
 
-    if (cf_strategy != CFStrategy::ghostnodes) ng = ng_sol;
+    if (cf_strategy != CFStrategy::ghostnodes) ng = ng_sol * linop.smootherHaloDepth();
     cor.resize(namrlevs);
     for (int alev = 0; alev <= finest_amr_lev; ++alev)
     {
@@ -1302,6 +1644,39 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
         cor_hold[alev][0]->setVal(0.0);
     }
 
+    use_float = do_mixed_precision && linop.supportFloat()
+        && cf_strategy != CFStrategy::ghostnodes;
+    if (do_mixed_precision && !use_float && verbose > 0) {
+        amrex::Warning("MLMG: mixed precision is not supported by this linear operator, ignored");
+    }
+    // smoothFloat is red/black Gauss-Seidel only.
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!(use_float && linop.info.use_chebyshev),
+                                     "MLMG: mixed precision does not support the Chebyshev smoother");
+    if (use_float && res_f.empty())
+    {
+        res_f.resize(namrlevs);
+        cor_f.resize(namrlevs);
+        rescor_f.resize(namrlevs);
+        for (int alev = 0; alev <= finest_amr_lev; ++alev)
+        {
+            const int nmglevs = linop.NMGLevels(alev);
+            res_f[alev].resize(nmglevs);
+            cor_f[alev].resize(nmglevs);
+            rescor_f[alev].resize(nmglevs);
+            for (int mglev = 0; mglev < nmglevs; ++mglev)
+            {
+                const BoxArray& ba = res[alev][mglev].boxArray();
+                const DistributionMapping& dm = res[alev][mglev].DistributionMap();
+                res_f[alev][mglev].define(ba, dm, ncomp, res[alev][mglev].nGrowVect());
+                cor_f[alev][mglev].define(ba, dm, ncomp, cor[alev][mglev]->nGrowVect());
+                rescor_f[alev][mglev].define(ba, dm, ncomp, rescor[alev][mglev].nGrowVect());
+                res_f[alev][mglev].setVal(0.f);
+                cor_f[alev][mglev].setVal(0.f);
+                rescor_f[alev][mglev].setVal(0.f);
+            }
+        }
+    }
+
     buildFineMask();
 
     if (!solve_called)
@@ -1514,12 +1889,7 @@ MLMG::compResidual (const Vector<MultiFab*>& a_res, const Vector<MultiFab*>& a_s
         }
     }
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
 
     const auto& amrrr = linop.AMRRefRatio();
 
@@ -1600,12 +1970,7 @@ MLMG::apply (const Vector<MultiFab*>& out, const Vector<MultiFab*>& a_in)
         rh[alev].setVal(0.0);
     }
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
 
     for (int alev = 0; alev < namrlevs; ++alev) {
         linop.applyInhomogNeumannTerm(alev, rh[alev]);
@@ -1868,6 +2233,8 @@ MLMG::bottomSolveWithHypre (MultiFab& x, const MultiFab& b)
     const int ncomp = linop.getNComp();
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncomp == 1, "bottomSolveWithHypre doesn't work with ncomp > 1");
 
+    auto setup_start_time = amrex::second();
+
     if (linop.isCellCentered())
     {
         if (hypre_solver == nullptr)  // We should reuse the setup
@@ -1897,6 +2264,7 @@ MLMG::bottomSolveWithHypre (MultiFab& x, const MultiFab& b)
                                              0.5*dx[1]*crse_ratio,
                                              0.5*dx[2]*crse_ratio));
             hypre_bndry->setLOBndryConds(linop.m_lobc, linop.m_hibc, -1, bclocation);
+            timer[setup_time] += amrex::second() - setup_start_time;
         }
 
         // IJ interface understands absolute tolerance API of hypre
@@ -1913,6 +2281,7 @@ MLMG::bottomSolveWithHypre (MultiFab& x, const MultiFab& b)
         {
             hypre_node_solver =
                 linop.makeHypreNodeLap(bottom_verbose, hypre_options_namespace);
+            timer[setup_time] += amrex::second() - setup_start_time;
         }
         hypre_node_solver->solve(x, b, bottom_reltol, bottom_abstol, bottom_maxiter);
     }
@@ -1939,6 +2308,7 @@ MLMG::bottomSolveWithPETSc (MultiFab& x, const MultiFab& b)
 
     if(petsc_solver == nullptr)
     {
+        auto setup_start_time = amrex::second();
         petsc_solver = linop.makePETSc();
         petsc_solver->setVerbose(bottom_verbose);
 
@@ -1954,11 +2324,41 @@ MLMG::bottomSolveWithPETSc (MultiFab& x, const MultiFab& b)
                                          0.5*dx[1]*crse_ratio,
                                          0.5*dx[2]*crse_ratio));
         petsc_bndry->setLOBndryConds(linop.m_lobc, linop.m_hibc, -1, bclocation);
+        timer[setup_time] += amrex::second() - setup_start_time;
     }
     petsc_solver->solve(x, b, bottom_reltol, Real(-1.), bottom_maxiter, *petsc_bndry, linop.getMaxOrder());
 #endif
 }
 
+void
+MLMG::bottomSolveWithFFT (MultiFab& x, const MultiFab& b)
+{
+#if !defined(AMREX_USE_SWFFT) || (AMREX_SPACEDIM != 3)
+    amrex::ignore_unused(x,b);
+    amrex::Abort("bottomSolveWithFFT is called without building 3D AMReX with SWFFT");
+#else
+    if (fft_solver == nullptr)
+    {
+        auto setup_start_time = amrex::second();
+
+        const Geometry& geom = linop.m_geom[0].back();
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(dynamic_cast<MLPoisson*>(&linop) != nullptr &&
+                                         geom.isAllPeriodic() &&
+                                         linop.m_grids[0].back().numPts() == geom.Domain().numPts(),
+                                         "bottomSolveWithFFT only works with MLPoisson on a fully periodic domain");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!x.hasEBFabFactory(),
+                                         "bottomSolveWithFFT doesn't work with EB");
+
+        fft_solver = std::make_unique<FFTPoisson>(geom);
+        timer[setup_time] += amrex::second() - setup_start_time;
+    }
+
+    // The solve is exact, up to round-off.
+    fft_solver->solve(x, b);
+    m_niters_cg.push_back(0);
+#endif
+}
+
 void
 MLMG::checkPoint (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rhs,
                   Real a_tol_rel, Real a_tol_abs, const char* a_file_name) const
@@ -390,12 +390,36 @@ MacProjector::setOptions ()
     {
         m_mlmg->setBottomSolver(MLMG::BottomSolver::cgbicg);
     }
+    else if (bottom_solver == "pipelined_bicg")
+    {
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::pipelined_bicgstab);
+    }
+    else if (bottom_solver == "pipelined_cg")
+    {
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::pipelined_cg);
+    }
+    else if (bottom_solver == "amg")
+    {
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::amg);
+    }
+    else if (bottom_solver == "direct")
+    {
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::direct);
+    }
     else if (bottom_solver == "hypre")
     {
 #ifdef AMREX_USE_HYPRE
         m_mlmg->setBottomSolver(MLMG::BottomSolver::hypre);
 #else
         amrex::Abort("AMReX was not built with HYPRE support");
+#endif
+    }
+    else if (bottom_solver == "fft")
+    {
+#ifdef AMREX_USE_SWFFT
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::fft);
+#else
+        amrex::Abort("AMReX was not built with SWFFT support");
 #endif
     }
 }
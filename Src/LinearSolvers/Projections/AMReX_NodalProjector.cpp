@@ -205,6 +205,14 @@ NodalProjector::setOptions ()
     {
         m_mlmg->setBottomSolver(MLMG::BottomSolver::cgbicg);
     }
+    else if (bottom_solver == "pipelined_bicg")
+    {
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::pipelined_bicgstab);
+    }
+    else if (bottom_solver == "pipelined_cg")
+    {
+        m_mlmg->setBottomSolver(MLMG::BottomSolver::pipelined_cg);
+    }
 #ifdef AMREX_USE_HYPRE
     else if (bottom_solver == "hypre")
     {
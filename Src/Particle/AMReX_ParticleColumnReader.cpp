@@ -0,0 +1,258 @@
+#include <AMReX_ParticleColumnReader.H>
+#include <AMReX_FPC.H>
+#include <AMReX_IntConv.H>
+#include <AMReX_NFiles.H>
+#include <AMReX_Utility.H>
+#include <AMReX_BLassert.H>
+
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace amrex {
+
+namespace {
+
+template <typename T>
+Vector<int> selectByRange (const Vector<ColumnarParticleReader::Chunk>& chunks,
+                           Vector<T> ColumnarParticleReader::Chunk::* vmin,
+                           Vector<T> ColumnarParticleReader::Chunk::* vmax,
+                           int comp, T lo, T hi)
+{
+    Vector<int> r;
+    for (int i = 0, N = chunks.size(); i < N; ++i) {
+        const auto& c = chunks[i];
+        if (c.count > 0 && (c.*vmax)[comp] >= lo && (c.*vmin)[comp] <= hi) {
+            r.push_back(i);
+        }
+    }
+    return r;
+}
+
+}
+
+RealBox
+ColumnarParticleReader::Chunk::boundingBox () const noexcept
+{
+    RealBox rb;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        rb.setLo(idim, static_cast<Real>(real_min[idim]));
+        rb.setHi(idim, static_cast<Real>(real_max[idim]));
+    }
+    return rb;
+}
+
+ColumnarParticleReader::ColumnarParticleReader (const std::string& dir)
+{
+    define(dir);
+}
+
+void
+ColumnarParticleReader::define (const std::string& dir)
+{
+    m_dir = dir;
+    if ( ! m_dir.empty() && m_dir[m_dir.size()-1] != '/') m_dir += '/';
+
+    std::string HdrFileName = m_dir + "Header";
+    std::ifstream HdrFile(HdrFileName.c_str(), std::ios::in);
+    if ( ! HdrFile.good()) amrex::FileOpenFailed(HdrFileName);
+
+    HdrFile >> m_version;
+    if (m_version != FormatVersion()) {
+        amrex::Abort("ColumnarParticleReader: unknown version " + m_version + " in " + HdrFileName);
+    }
+
+    HdrFile >> m_real_descriptor;
+    HdrFile >> m_int_descriptor;
+
+    int dm;
+    HdrFile >> dm;
+    if (dm != AMREX_SPACEDIM) {
+        amrex::Abort("ColumnarParticleReader: file was written with a different AMREX_SPACEDIM");
+    }
+
+    int nr;
+    HdrFile >> nr;
+    m_real_names.resize(nr);
+    for (auto& name : m_real_names) HdrFile >> name;
+
+    int ni;
+    HdrFile >> ni;
+    m_int_names.resize(ni);
+    for (auto& name : m_int_names) HdrFile >> name;
+
+    HdrFile >> m_chunk_size;
+    HdrFile >> m_nparticles;
+    HdrFile >> m_finest_level;
+
+    int nchunks;
+    HdrFile >> nchunks;
+    m_chunks.resize(nchunks);
+    for (auto& c : m_chunks)
+    {
+        HdrFile >> c.level >> c.grid >> c.file >> c.count >> c.offset;
+        c.real_min.resize(nr);
+        c.real_max.resize(nr);
+        for (int j = 0; j < nr; ++j) HdrFile >> c.real_min[j] >> c.real_max[j];
+        c.int_min.resize(ni);
+        c.int_max.resize(ni);
+        for (int j = 0; j < ni; ++j) HdrFile >> c.int_min[j] >> c.int_max[j];
+    }
+
+    if ( ! HdrFile.good()) {
+        amrex::Abort("ColumnarParticleReader: problem reading " + HdrFileName);
+    }
+}
+
+int
+ColumnarParticleReader::realComp (const std::string& name) const noexcept
+{
+    for (int i = 0, N = m_real_names.size(); i < N; ++i) {
+        if (m_real_names[i] == name) return i;
+    }
+    return -1;
+}
+
+int
+ColumnarParticleReader::intComp (const std::string& name) const noexcept
+{
+    for (int i = 0, N = m_int_names.size(); i < N; ++i) {
+        if (m_int_names[i] == name) return i;
+    }
+    return -1;
+}
+
+Vector<int>
+ColumnarParticleReader::selectChunks (const RealBox& region, int lev) const
+{
+    Vector<int> r;
+    for (int i = 0, N = m_chunks.size(); i < N; ++i) {
+        const auto& c = m_chunks[i];
+        if (c.count == 0 || (lev >= 0 && c.level != lev)) continue;
+        bool overlap = true;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (c.real_max[idim] < region.lo(idim) || c.real_min[idim] > region.hi(idim)) {
+                overlap = false;
+            }
+        }
+        if (overlap) r.push_back(i);
+    }
+    return r;
+}
+
+Vector<int>
+ColumnarParticleReader::selectChunksByReal (int comp, ParticleReal lo, ParticleReal hi) const
+{
+    AMREX_ALWAYS_ASSERT(comp >= 0 && comp < numRealComps());
+    return selectByRange(m_chunks, &Chunk::real_min, &Chunk::real_max, comp, lo, hi);
+}
+
+Vector<int>
+ColumnarParticleReader::selectChunksByInt (int comp, int lo, int hi) const
+{
+    AMREX_ALWAYS_ASSERT(comp >= 0 && comp < numIntComps());
+    return selectByRange(m_chunks, &Chunk::int_min, &Chunk::int_max, comp, lo, hi);
+}
+
+std::string
+ColumnarParticleReader::FileName (int file) const
+{
+    return NFilesIter::FileName(file, m_dir + DataPrefix());
+}
+
+void
+ColumnarParticleReader::readBytes (int file, Long offset, Long nbytes, char* dst) const
+{
+    if (nbytes <= 0) return;
+    const std::string fname = FileName(file);
+#ifndef _WIN32
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) amrex::FileOpenFailed(fname);
+    Long nread = 0;
+    while (nread < nbytes) {
+        ssize_t n = ::pread(fd, dst+nread, nbytes-nread, offset+nread);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ::close(fd);
+            amrex::Abort("ColumnarParticleReader: failed to read " + fname);
+        }
+        nread += n;
+    }
+    ::close(fd);
+#else
+    std::ifstream ifs(fname.c_str(), std::ios::in | std::ios::binary);
+    if ( ! ifs.good()) amrex::FileOpenFailed(fname);
+    ifs.seekg(offset, std::ios::beg);
+    ifs.read(dst, nbytes);
+    if ( ! ifs.good()) amrex::Abort("ColumnarParticleReader: failed to read " + fname);
+#endif
+}
+
+void
+ColumnarParticleReader::readRealComp (int ichunk, int comp, ParticleReal* dst) const
+{
+    AMREX_ALWAYS_ASSERT(comp >= 0 && comp < numRealComps());
+    const Chunk& c = m_chunks[ichunk];
+    const Long nbytes_file = m_real_descriptor.numBytes();
+    const Long offset = c.offset + comp*c.count*nbytes_file;
+
+    const RealDescriptor& native = (sizeof(ParticleReal) == 4) ? FPC::Native32RealDescriptor()
+                                                               : FPC::Native64RealDescriptor();
+    if (m_real_descriptor == native)
+    {
+        readBytes(c.file, offset, c.count*nbytes_file, reinterpret_cast<char*>(dst));
+    }
+    else
+    {
+        std::string buf(c.count*nbytes_file, '\0');
+        readBytes(c.file, offset, buf.size(), &buf[0]);
+        std::istringstream iss(buf);
+        if (std::is_same<ParticleReal,float>::value) {
+            RealDescriptor::convertToNativeFloatFormat((float*)dst, c.count, iss, m_real_descriptor);
+        } else {
+            RealDescriptor::convertToNativeDoubleFormat((double*)dst, c.count, iss, m_real_descriptor);
+        }
+    }
+}
+
+void
+ColumnarParticleReader::readIntComp (int ichunk, int comp, int* dst) const
+{
+    AMREX_ALWAYS_ASSERT(comp >= 0 && comp < numIntComps());
+    AMREX_ALWAYS_ASSERT(m_int_descriptor.numBytes() == sizeof(int));
+    const Chunk& c = m_chunks[ichunk];
+    const Long real_bytes = numRealComps()*c.count*m_real_descriptor.numBytes();
+    const Long offset = c.offset + real_bytes + comp*c.count*sizeof(int);
+
+    readBytes(c.file, offset, c.count*sizeof(int), reinterpret_cast<char*>(dst));
+
+    if (m_int_descriptor.order() != FPC::NativeIntDescriptor().order()) {
+        for (Long i = 0; i < c.count; ++i) {
+            dst[i] = swapBytes(static_cast<std::int32_t>(dst[i]));
+        }
+    }
+}
+
+Vector<ParticleReal>
+ColumnarParticleReader::readRealComp (int ichunk, int comp) const
+{
+    Vector<ParticleReal> r(m_chunks[ichunk].count);
+    readRealComp(ichunk, comp, r.dataPtr());
+    return r;
+}
+
+Vector<int>
+ColumnarParticleReader::readIntComp (int ichunk, int comp) const
+{
+    Vector<int> r(m_chunks[ichunk].count);
+    readIntComp(ichunk, comp, r.dataPtr());
+    return r;
+}
+
+}
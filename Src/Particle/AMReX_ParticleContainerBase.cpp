@@ -85,6 +85,42 @@ void ParticleContainerBase::SetParticleDistributionMap (int lev, const Distribut
     m_gdb->SetParticleDistributionMap(lev, new_dmap);
 }
 
+bool ParticleContainerBase::MakeBalancedDistributionMap (const LayoutData<Real>& cost,
+                                                         const ParticleLoadBalanceInfo& info,
+                                                         DistributionMapping& new_dm,
+                                                         Real* current_efficiency,
+                                                         Real* proposed_efficiency)
+{
+    BL_PROFILE("ParticleContainerBase::MakeBalancedDistributionMap()");
+
+    const int root = ParallelDescriptor::IOProcessorNumber();
+
+    // The proposed map and the efficiencies are only computed on root.
+    Real eff[2] = {0.0, 0.0};
+    DistributionMapping dm;
+    if (info.strategy == DistributionMapping::SFC) {
+        dm = DistributionMapping::makeSFC(cost, eff[0], eff[1], false, root);
+    } else {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(info.strategy == DistributionMapping::KNAPSACK,
+            "ParticleLoadBalanceInfo: strategy must be KNAPSACK or SFC");
+        dm = DistributionMapping::makeKnapSack(cost, eff[0], eff[1], info.knapsack_nmax, false, root);
+    }
+
+    ParallelDescriptor::Bcast(eff, 2, root);
+    if (current_efficiency) *current_efficiency = eff[0];
+    if (proposed_efficiency) *proposed_efficiency = eff[1];
+
+    if (eff[1] <= info.efficiency_ratio_threshold*eff[0]) return false;
+
+    Vector<int> pmap(cost.size());
+    if (ParallelDescriptor::MyProc() == root) {
+        pmap = dm.ProcessorMap();
+    }
+    ParallelDescriptor::Bcast(pmap.dataPtr(), pmap.size(), root);
+    new_dm = DistributionMapping(pmap);
+    return true;
+}
+
 void ParticleContainerBase::SetParticleGeometry (int lev, const Geometry& new_geom)
 {
     m_gdb_object = ParGDB(m_gdb->ParticleGeom(), m_gdb->ParticleDistributionMap(),
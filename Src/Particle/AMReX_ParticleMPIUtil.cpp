@@ -4,6 +4,9 @@
 #include <AMReX_ParallelReduce.H>
 #include <AMReX_BLProfiler.H>
 
+#include <cstring>
+#include <limits>
+
 namespace amrex {
 
 #ifdef AMREX_USE_MPI
@@ -92,6 +95,131 @@ namespace amrex {
 
         return NumSnds;
     }
+
+    Long exchangeBatchedSendBuffers (const Vector<const std::map<int, Vector<char> >*>& not_ours,
+                                     const Vector<int>& neighbor_procs,
+                                     Vector<char>& rcv_data,
+                                     Vector<Vector<Long> >& rcv_parts,
+                                     Vector<Vector<Long> >& rcv_counts,
+                                     Vector<Long>& num_snds)
+    {
+        BL_PROFILE("exchangeBatchedSendBuffers");
+
+        const int NProcs = ParallelContext::NProcsSub();
+        const int nparts = not_ours.size();
+
+        rcv_data.clear();
+        rcv_parts.clear();
+        rcv_parts.resize(nparts);
+        rcv_counts.clear();
+        rcv_counts.resize(nparts, Vector<Long>(NProcs, 0));
+        num_snds.assign(nparts+1, 0);
+
+        // Snds[who*nparts+c] is the number of bytes container c sends to who
+        Vector<Long> Snds(NProcs*nparts, 0);
+        for (int c = 0; c < nparts; ++c) {
+            for (const auto& kv : *not_ours[c]) {
+                num_snds[c] += kv.second.size();
+                num_snds[nparts] += kv.second.size();
+                Snds[kv.first*nparts+c] = kv.second.size();
+            }
+        }
+
+        // the last one is for all the containers
+        ParallelAllReduce::Max(num_snds.data(), nparts+1, ParallelContext::CommunicatorSub());
+        const Long NumSnds = num_snds[nparts];
+        num_snds.pop_back();
+
+        if (NumSnds == 0) return NumSnds;
+
+        const int num_nbors = neighbor_procs.size();
+        Vector<Long> Rcvs(NProcs*nparts, 0);
+
+        {
+            const int SeqNum = ParallelDescriptor::SeqNum();
+
+            Vector<MPI_Status>  stats(num_nbors);
+            Vector<MPI_Request> rreqs(num_nbors);
+
+            for (int i = 0; i < num_nbors; ++i) {
+                const int Who = neighbor_procs[i];
+                AMREX_ASSERT(Who >= 0 && Who < NProcs);
+                rreqs[i] = ParallelDescriptor::Arecv(&Rcvs[Who*nparts], nparts, Who, SeqNum,
+                                                     ParallelContext::CommunicatorSub()).req();
+            }
+
+            for (int i = 0; i < num_nbors; ++i) {
+                const int Who = neighbor_procs[i];
+                ParallelDescriptor::Send(&Snds[Who*nparts], nparts, Who, SeqNum,
+                                         ParallelContext::CommunicatorSub());
+            }
+
+            if (num_nbors > 0) ParallelDescriptor::Waitall(rreqs, stats);
+        }
+
+        Vector<int> RcvProc;
+        Vector<Long> rOffset;
+        Long TotRcvBytes = 0;
+        for (int i = 0; i < NProcs; ++i) {
+            Long nbytes = 0;
+            for (int c = 0; c < nparts; ++c) {
+                if (Rcvs[i*nparts+c] > 0) {
+                    rcv_parts[c].push_back(TotRcvBytes + nbytes);
+                }
+                rcv_counts[c][i] = Rcvs[i*nparts+c];
+                nbytes += Rcvs[i*nparts+c];
+            }
+            if (nbytes > 0) {
+                RcvProc.push_back(i);
+                rOffset.push_back(TotRcvBytes);
+                TotRcvBytes += nbytes;
+            }
+        }
+
+        rcv_data.resize(TotRcvBytes);
+
+        const int nrcvs = RcvProc.size();
+        Vector<MPI_Status>  stats(nrcvs);
+        Vector<MPI_Request> rreqs(nrcvs);
+
+        const int SeqNum = ParallelDescriptor::SeqNum();
+
+        for (int i = 0; i < nrcvs; ++i) {
+            const int Who = RcvProc[i];
+            const Long Cnt = (i+1 < nrcvs ? rOffset[i+1] : TotRcvBytes) - rOffset[i];
+
+            AMREX_ASSERT(Cnt < std::numeric_limits<int>::max());
+
+            rreqs[i] = ParallelDescriptor::Arecv(&rcv_data[rOffset[i]], Cnt, Who, SeqNum,
+                                                 ParallelContext::CommunicatorSub()).req();
+        }
+
+        // combine the parts going to the same rank into one message
+        Vector<char> snd_data;
+        for (int who = 0; who < NProcs; ++who) {
+            Long Cnt = 0;
+            for (int c = 0; c < nparts; ++c) Cnt += Snds[who*nparts+c];
+            if (Cnt == 0) continue;
+
+            AMREX_ASSERT(Cnt < std::numeric_limits<int>::max());
+
+            snd_data.resize(Cnt);
+            char* dst = snd_data.data();
+            for (int c = 0; c < nparts; ++c) {
+                if (Snds[who*nparts+c] == 0) continue;
+                const auto& buf = not_ours[c]->at(who);
+                std::memcpy(dst, buf.data(), buf.size());
+                dst += buf.size();
+            }
+
+            ParallelDescriptor::Send(snd_data.data(), Cnt, who, SeqNum,
+                                     ParallelContext::CommunicatorSub());
+        }
+
+        if (nrcvs > 0) ParallelDescriptor::Waitall(rreqs, stats);
+
+        return NumSnds;
+    }
 #endif  // AMREX_USE_MPI
 
 }
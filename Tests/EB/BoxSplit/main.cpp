@@ -0,0 +1,107 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+
+#include <limits>
+#include <memory>
+
+using namespace amrex;
+
+// A rotated box with a sphere on a corner and a hole through it, and a
+// scaled ellipsoid next to it, so that the bounds go through unions,
+// differences, translations, rotations and scalings.
+static auto makeGeometry ()
+{
+    EB2::BoxIF box({AMREX_D_DECL(-0.2,-0.15,-0.25)}, {AMREX_D_DECL(0.2,0.15,0.25)}, false);
+    auto rotated = EB2::translate(EB2::rotate(box, 0.3, AMREX_SPACEDIM-1),
+                                  {AMREX_D_DECL(0.4,0.45,0.5)});
+    EB2::SphereIF corner(0.1, {AMREX_D_DECL(0.6,0.6,0.5)}, false);
+    EB2::SphereIF hole(0.08, {AMREX_D_DECL(0.4,0.45,0.5)}, false);
+    EB2::EllipsoidIF ellipsoid({AMREX_D_DECL(0.1,0.05,0.08)}, {AMREX_D_DECL(0.,0.,0.)}, false);
+    auto scaled = EB2::translate(EB2::scale(ellipsoid, {AMREX_D_DECL(1.2,0.8,1.0)}),
+                                 {AMREX_D_DECL(0.75,0.25,0.5)});
+    return EB2::makeUnion(EB2::makeDifference(EB2::makeUnion(rotated, corner), hole), scaled);
+}
+
+static Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), 0);
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), 0);
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), 0);
+    return d.norm0();
+}
+
+// Number of cells whose flags differ
+static Long numFlagDiffs (const FabArray<EBCellFlagFab>& a, const FabArray<EBCellFlagFab>& b)
+{
+    Long r = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        auto const& x = a.const_array(mfi);
+        auto const& y = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k)
+        {
+            if (x(i,j,k).getValue() != y(i,j,k).getValue()) { ++r; }
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(r);
+    return r;
+}
+
+// Checks that the EB does not depend on how GeometryShop splits the boxes
+// it classifies with the bounds of the implicit function: with the default
+// number of sampled points, with boxes split down to a few nodes, and with
+// every box sampled without splitting.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        auto shop = EB2::makeShop(makeGeometry());
+        const Long default_points = shop.maxSampledPoints();
+
+        EB2::Build(shop, geom, 0, 0);
+        auto ref = makeEBFabFactory(geom, ba, dm, {AMREX_D_DECL(2,2,2)}, EBSupport::full);
+
+        bool ok = true;
+        for (Long npoints : {Long(8), std::numeric_limits<Long>::max()})
+        {
+            shop.setMaxSampledPoints(npoints);
+            EB2::Build(shop, geom, 0, 0);
+            auto factory = makeEBFabFactory(geom, ba, dm, {AMREX_D_DECL(2,2,2)}, EBSupport::full);
+
+            const Long nflags = numFlagDiffs(factory->getMultiEBCellFlagFab(),
+                                             ref->getMultiEBCellFlagFab());
+            const Real dvol = maxDiff(factory->getVolFrac(), ref->getVolFrac());
+            amrex::Print() << "max sampled points " << npoints << " vs " << default_points
+                           << ": flag diffs " << nflags << ", max volfrac diff " << dvol << "\n";
+            ok = ok && nflags == 0 && dvol == 0.0;
+
+            factory.reset();
+            EB2::IndexSpace::pop();
+        }
+
+        AMREX_ALWAYS_ASSERT(ok);
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,102 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EB2_IF_UnionList.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <random>
+
+using namespace amrex;
+
+// Time EB2::Build for a union of spheres versus the number of spheres and
+// the number of threads.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_coarsening_level = 2;
+        int nrepeat = 2;
+        Vector<int> nspheres{1, 8, 64};
+        Vector<int> nthreads{OpenMP::get_max_threads()};
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_coarsening_level", max_coarsening_level);
+            pp.query("nrepeat", nrepeat);
+            pp.queryarr("nspheres", nspheres);
+            pp.queryarr("nthreads", nthreads);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        // The ghost nodes outside the domain are evaluated too.
+        const RealBox search_box({AMREX_D_DECL(-0.5,-0.5,-0.5)}, {AMREX_D_DECL(1.5,1.5,1.5)});
+
+        amrex::Print() << "EB2::Build of " << n_cell << "^3 cells, eb2.max_grid_size "
+                       << EB2::max_grid_size << ", " << ParallelDescriptor::NProcs()
+                       << " ranks\n";
+        amrex::Print() << "  nspheres  nthreads  time (s)\n";
+
+        for (int nsph : nspheres)
+        {
+            // The spheres are put in the cells of an m^3 lattice with random
+            // shifts that are the same on every rank.  They do not touch, so
+            // that there are no multiple cuts.
+            int m = 1;
+            while (m*m*m < nsph) { ++m; }
+            const Real h = Real(0.8) / m;
+            const Real radius = Real(0.25) * h;
+            std::mt19937 gen(42);
+            std::uniform_real_distribution<Real> shift(-Real(0.05)*h, Real(0.05)*h);
+            Vector<EB2::SphereIF> spheres;
+            for (int i = 0; i < nsph; ++i) {
+                const int ii[] = {i%m, (i/m)%m, i/(m*m)};
+                RealArray c;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    c[idim] = Real(0.1) + (ii[idim]+Real(0.5))*h + shift(gen);
+                }
+                spheres.emplace_back(radius, c, false);
+            }
+            auto bed = std::make_shared<EB2::UnionList<EB2::SphereIF> >(spheres, search_box);
+            auto shop = EB2::makeShop(bed->implicitFunction(), bed);
+
+            for (int nt : nthreads)
+            {
+#ifdef AMREX_USE_OMP
+                omp_set_num_threads(nt);
+#else
+                amrex::ignore_unused(nt);
+#endif
+                Real tbest = std::numeric_limits<Real>::max();
+                for (int irep = 0; irep < nrepeat; ++irep)
+                {
+                    ParallelDescriptor::Barrier();
+                    Real t0 = amrex::second();
+                    EB2::Build(shop, geom, 0, max_coarsening_level, 4);
+                    Real t = amrex::second() - t0;
+                    ParallelDescriptor::ReduceRealMax(t);
+                    tbest = std::min(tbest, t);
+                    EB2::IndexSpace::pop();
+                }
+                amrex::Print() << std::setw(10) << nsph << std::setw(10)
+                               << OpenMP::get_max_threads() << "  " << tbest << "\n";
+            }
+        }
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,233 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_Utility.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+
+#include <algorithm>
+#include <string>
+
+using namespace amrex;
+
+// The fluid is inside a sphere that cuts the faces of the domain, so that
+// there are covered boxes, and outside of a small sphere.
+static auto makeShop ()
+{
+    EB2::SphereIF outer(0.6, {0.5,0.5,0.5}, true);
+    EB2::SphereIF inner(0.15, {0.45,0.5,0.55}, false);
+    return EB2::makeShop(EB2::makeUnion(outer, inner));
+}
+
+// The data that the fill functions of a level give, with ghost cells
+struct LevelData
+{
+    FabArray<EBCellFlagFab> flag;
+    MultiFab volfrac, centroid, bndryarea, bndrycent, bndrynorm, levelset;
+    Array<MultiFab,AMREX_SPACEDIM> areafrac, facecent, edgecent;
+    BoxArray grids;
+    bool allregular;
+
+    LevelData (const EB2::Level& lev, const Geometry& geom, const BoxArray& ba,
+               const DistributionMapping& dm, int ng)
+        : flag(ba, dm, 1, ng),
+          volfrac(ba, dm, 1, ng),
+          centroid(ba, dm, AMREX_SPACEDIM, ng),
+          bndryarea(ba, dm, 1, ng),
+          bndrycent(ba, dm, AMREX_SPACEDIM, ng),
+          bndrynorm(ba, dm, AMREX_SPACEDIM, ng),
+          levelset(amrex::convert(ba,IntVect::TheNodeVector()), dm, 1, ng),
+          grids(lev.boxArray()),
+          allregular(lev.isAllRegular())
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            IntVect edge_type{1}; edge_type[idim] = 0;
+            areafrac[idim].define(amrex::convert(ba,IntVect::TheDimensionVector(idim)), dm, 1, ng);
+            facecent[idim].define(amrex::convert(ba,IntVect::TheDimensionVector(idim)), dm,
+                                  AMREX_SPACEDIM-1, ng);
+            edgecent[idim].define(amrex::convert(ba,edge_type), dm, 1, ng);
+        }
+        // Not all the fill functions fill the ghost cells outside the domain.
+        for (MultiFab* mf : {&volfrac, &centroid, &bndryarea, &bndrycent, &bndrynorm, &levelset}) {
+            mf->setVal(0.0);
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            areafrac[idim].setVal(0.0);
+            facecent[idim].setVal(0.0);
+            edgecent[idim].setVal(0.0);
+        }
+        lev.fillEBCellFlag(flag, geom);
+        lev.fillVolFrac(volfrac, geom);
+        lev.fillCentroid(centroid, geom);
+        lev.fillBndryArea(bndryarea, geom);
+        lev.fillBndryCent(bndrycent, geom);
+        lev.fillBndryNorm(bndrynorm, geom);
+        lev.fillAreaFrac(GetArrOfPtrs(areafrac), geom);
+        lev.fillFaceCent(GetArrOfPtrs(facecent), geom);
+        lev.fillEdgeCent(GetArrOfPtrs(edgecent), geom);
+        lev.fillLevelSet(levelset, geom);
+    }
+};
+
+static Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    AMREX_ALWAYS_ASSERT(a.boxArray() == b.boxArray() && a.nComp() == b.nComp() &&
+                        a.nGrow() == b.nGrow());
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrow());
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), a.nGrow());
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), a.nGrow());
+    return d.norm0(0, a.nComp(), a.nGrowVect());
+}
+
+// Number of cells whose flags differ, plus the number of boxes whose type differs
+static Long numFlagDiffs (const FabArray<EBCellFlagFab>& a, const FabArray<EBCellFlagFab>& b)
+{
+    Long r = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        if (a[mfi].getType() != b[mfi].getType()) { ++r; }
+        auto const& x = a.const_array(mfi);
+        auto const& y = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k)
+        {
+            if (x(i,j,k).getValue() != y(i,j,k).getValue()) { ++r; }
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(r);
+    return r;
+}
+
+static Real maxDiff (const LevelData& a, const LevelData& b)
+{
+    // The grids of a coarse level built from the geometry are a coarsened
+    // BoxArray, so compare the boxes.
+    AMREX_ALWAYS_ASSERT(a.grids.boxList() == b.grids.boxList() && a.allregular == b.allregular);
+    AMREX_ALWAYS_ASSERT(numFlagDiffs(a.flag, b.flag) == 0);
+    Real d = maxDiff(a.volfrac, b.volfrac);
+    d = std::max(d, maxDiff(a.centroid, b.centroid));
+    d = std::max(d, maxDiff(a.bndryarea, b.bndryarea));
+    d = std::max(d, maxDiff(a.bndrycent, b.bndrycent));
+    d = std::max(d, maxDiff(a.bndrynorm, b.bndrynorm));
+    d = std::max(d, maxDiff(a.levelset, b.levelset));
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        d = std::max(d, maxDiff(a.areafrac[idim], b.areafrac[idim]));
+        d = std::max(d, maxDiff(a.facecent[idim], b.facecent[idim]));
+        d = std::max(d, maxDiff(a.edgecent[idim], b.edgecent[idim]));
+    }
+    return d;
+}
+
+static std::string readFile (const std::string& name)
+{
+    Vector<char> chars;
+    ParallelDescriptor::ReadAndBcastFile(name, chars);
+    return std::string(chars.dataPtr());
+}
+
+// Compares the files of a level written from the geometry with those written
+// from the data read back.  These have the ghost cells of the level, and the
+// cell flags split into two 16-bit components.  Returns the largest value of
+// the upper 16 bits of the cell flags.
+static Real compareLevelFiles (const std::string& dir1, const std::string& dir2)
+{
+    AMREX_ALWAYS_ASSERT(readFile(dir1+"/Header") == readFile(dir2+"/Header"));
+    if (!amrex::FileExists(dir1+"/CellFlag_H")) { return 0.0; } // all regular
+
+    Vector<std::string> names{"CellFlag", "VolFrac", "Centroid", "BndryArea", "BndryCent",
+                              "BndryNorm", "LevelSet"};
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        for (std::string name : {"AreaFrac_", "FaceCent_", "EdgeCent_"}) {
+            names.push_back(name + std::to_string(idim));
+        }
+    }
+    Real flag_hi = 0.0;
+    for (auto const& name : names) {
+        MultiFab a, b;
+        VisMF::Read(a, dir1+"/"+name);
+        VisMF::Read(b, dir2+"/"+name);
+        const Real d = maxDiff(a, b);
+        if (d != 0.0) {
+            amrex::Abort(dir2+"/"+name+" differs from "+dir1+"/"+name);
+        }
+        if (name == "CellFlag") {
+            flag_hi = a.max(1, a.nGrow());
+        }
+    }
+    return flag_hi;
+}
+
+// Writes the EB data built from a geometry, reads them back with
+// EB2::BuildFromChkptFile, and checks that all data of all levels are the
+// same.  The data read back are written again, and the two directories
+// are compared too.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_coarsening_level = 2;
+        std::string chkpt_dir = "eb_chkpt";
+        std::string chkpt_dir_2 = "eb_chkpt_2";
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_coarsening_level", max_coarsening_level);
+            pp.query("chkpt_dir", chkpt_dir);
+            pp.query("chkpt_dir_2", chkpt_dir_2);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        const std::string key = "Tests/EB/Chkpt";
+        EB2::Build(makeShop(), geom, 0, max_coarsening_level);
+        AMREX_ALWAYS_ASSERT(EB2::IndexSpace::top().coarsestDomain()
+                            == amrex::coarsen(geom.Domain(), 1 << max_coarsening_level));
+
+        Vector<Geometry> geoms;
+        Vector<std::unique_ptr<LevelData> > built;
+        for (int ilev = 0; ilev <= max_coarsening_level; ++ilev) {
+            geoms.push_back(amrex::coarsen(geom, 1 << ilev));
+            BoxArray ba(geoms[ilev].Domain());
+            ba.maxSize(8);
+            DistributionMapping dm(ba);
+            built.emplace_back(std::make_unique<LevelData>
+                               (EB2::IndexSpace::top().getLevel(geoms[ilev]),
+                                geoms[ilev], ba, dm, 2));
+        }
+        EB2::IndexSpace::top().writeChkptFile(chkpt_dir, key);
+        EB2::IndexSpace::pop();
+
+        EB2::BuildFromChkptFile(chkpt_dir, geom, 0, max_coarsening_level, key);
+        AMREX_ALWAYS_ASSERT(EB2::IndexSpace::top().coarsestDomain()
+                            == geoms.back().Domain());
+        for (int ilev = 0; ilev <= max_coarsening_level; ++ilev) {
+            auto const& b = *built[ilev];
+            LevelData r(EB2::IndexSpace::top().getLevel(geoms[ilev]), geoms[ilev],
+                        b.volfrac.boxArray(), b.volfrac.DistributionMap(), 2);
+            const Real d = maxDiff(b, r);
+            amrex::Print() << "level " << ilev << ": max diff " << d << "\n";
+            AMREX_ALWAYS_ASSERT(d == 0.0);
+        }
+
+        EB2::IndexSpace::top().writeChkptFile(chkpt_dir_2, key);
+        AMREX_ALWAYS_ASSERT(readFile(chkpt_dir+"/Header") == readFile(chkpt_dir_2+"/Header"));
+        for (int ilev = 0; ilev <= max_coarsening_level; ++ilev) {
+            const Real flag_hi = compareLevelFiles(amrex::LevelFullPath(ilev, chkpt_dir),
+                                                   amrex::LevelFullPath(ilev, chkpt_dir_2));
+            amrex::Print() << "level " << ilev << ": files are the same, upper 16 bits of"
+                           << " the cell flags up to " << flag_hi << "\n";
+            // The cell flags have to use the upper 16 bits for the test to be
+            // of any use.
+            AMREX_ALWAYS_ASSERT(ilev > 0 || flag_hi > 0.0);
+        }
+        EB2::IndexSpace::pop();
+    }
+    amrex::Finalize();
+}
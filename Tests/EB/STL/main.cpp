@@ -0,0 +1,224 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+#include <AMReX_EB_STL_utils.H>
+#include <AMReX_EB2_IF_STL.H>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace amrex;
+
+namespace {
+    const Real radius = 0.3;
+    const Real center = 0.5;
+    using Point = std::array<Real,3>;
+    using Triangle = std::array<Point,3>;
+}
+
+static Point normalize (Point const& a)
+{
+    Real r = std::sqrt(a[0]*a[0]+a[1]*a[1]+a[2]*a[2]);
+    return {a[0]/r, a[1]/r, a[2]/r};
+}
+
+// Triangles of an icosahedron refined nrefine times and projected on the
+// sphere, with the normals pointing outward.
+static std::vector<Triangle> makeSphere (int nrefine)
+{
+    const Real t = (1.0+std::sqrt(5.0))/2.0;
+    std::vector<Point> v{{-1,t,0},{1,t,0},{-1,-t,0},{1,-t,0},{0,-1,t},{0,1,t},
+                         {0,-1,-t},{0,1,-t},{t,0,-1},{t,0,1},{-t,0,-1},{-t,0,1}};
+    for (auto& p : v) { p = normalize(p); }
+    const int faces[20][3] = {{0,11,5},{0,5,1},{0,1,7},{0,7,10},{0,10,11},{1,5,9},{5,11,4},
+                              {11,10,2},{10,7,6},{7,1,8},{3,9,4},{3,4,2},{3,2,6},{3,6,8},
+                              {3,8,9},{4,9,5},{2,4,11},{6,2,10},{8,6,7},{9,8,1}};
+    std::vector<Triangle> tris;
+    for (auto const& f : faces) {
+        tris.push_back({v[f[0]], v[f[1]], v[f[2]]});
+    }
+    auto mid = [] (Point const& a, Point const& b) {
+        return normalize({a[0]+b[0], a[1]+b[1], a[2]+b[2]});
+    };
+    for (int l = 0; l < nrefine; ++l) {
+        std::vector<Triangle> fine;
+        for (auto const& tr : tris) {
+            Point a = mid(tr[0],tr[1]), b = mid(tr[1],tr[2]), c = mid(tr[2],tr[0]);
+            fine.push_back({tr[0],a,c});
+            fine.push_back({tr[1],b,a});
+            fine.push_back({tr[2],c,b});
+            fine.push_back({a,b,c});
+        }
+        tris.swap(fine);
+    }
+    for (auto& tr : tris) {
+        for (auto& p : tr) {
+            for (auto& x : p) { x = center + radius*x; }
+        }
+    }
+    return tris;
+}
+
+static void writeAsciiSTL (std::string const& name, std::vector<Triangle> const& tris)
+{
+    std::ofstream ofs(name);
+    ofs.precision(17);
+    ofs << "solid sphere\n";
+    for (auto const& tr : tris) {
+        ofs << "facet normal 0 0 0\nouter loop\n";
+        for (auto const& p : tr) {
+            ofs << "vertex " << p[0] << " " << p[1] << " " << p[2] << "\n";
+        }
+        ofs << "endloop\nendfacet\n";
+    }
+    ofs << "endsolid sphere\n";
+}
+
+// The header starts with "solid" like an ASCII file, so that the file can
+// only be told from an ASCII one by its size.
+static void writeBinarySTL (std::string const& name, std::vector<Triangle> const& tris)
+{
+    std::ofstream ofs(name, std::ios::binary);
+    char header[80] = {0};
+    std::strcpy(header, "solid sphere");
+    ofs.write(header, 80);
+    const auto ntri = static_cast<std::uint32_t>(tris.size());
+    ofs.write(reinterpret_cast<char const*>(&ntri), 4);
+    for (auto const& tr : tris) {
+        float data[12] = {0.f, 0.f, 0.f};
+        for (int i = 0; i < 3; ++i) {
+            for (int idim = 0; idim < 3; ++idim) {
+                data[3+3*i+idim] = static_cast<float>(tr[i][idim]);
+            }
+        }
+        ofs.write(reinterpret_cast<char const*>(data), 48);
+        const std::uint16_t attribute = 0;
+        ofs.write(reinterpret_cast<char const*>(&attribute), 2);
+    }
+}
+
+// Distance to the triangles of q without the hierarchy
+static Real bruteForceDistance (STLQuery const& q, Real p[3])
+{
+    Real d2 = std::numeric_limits<Real>::max();
+    for (int tr = 0; tr < q.num_tri; ++tr) {
+        Real t1[3], t2[3], t3[3];
+        q.getTriangle(tr, t1, t2, t3);
+        d2 = std::min(d2, tri_geom_ops::point_tri_distance2(p, t1, t2, t3));
+    }
+    return std::sqrt(d2);
+}
+
+// Number of points where the inside test does not agree with the sphere,
+// away from the surface, or the distance with the hierarchy is not that
+// of all the triangles
+static Long checkQuery (STLtools const& stl, int npoints)
+{
+    const STLQuery q = stl.hostQuery();
+    Long nbad = 0;
+    for (int n = 0; n < npoints; ++n) {
+        Real p[3] = {amrex::Random(), amrex::Random(), amrex::Random()};
+        const Real r = std::sqrt((p[0]-center)*(p[0]-center) + (p[1]-center)*(p[1]-center)
+                                 + (p[2]-center)*(p[2]-center));
+        if (std::abs(r-radius) > 0.01 && q.inside(p) != (r < radius)) { ++nbad; }
+
+        const Real d = bruteForceDistance(q, p);
+        if (q.distance(p) != d) { ++nbad; }
+        const Real dmax = 0.05;
+        if (q.distance(p, dmax) != std::min(d, dmax)) { ++nbad; }
+        if (q.signed_distance(p) != (q.inside(p) ? -d : d)) { ++nbad; }
+    }
+    ParallelDescriptor::ReduceLongSum(nbad);
+    return nbad;
+}
+
+// Number of boxes where STLIF::bounds does not bound the function at the
+// corners and at random points of the box
+static Long checkBounds (EB2::STLIF const& f, int nboxes)
+{
+    Long nbad = 0;
+    for (int n = 0; n < nboxes; ++n) {
+        const Real len = std::pow(Real(10.0), Real(-3.0)*amrex::Random());
+        RealArray lo, hi;
+        for (int idim = 0; idim < 3; ++idim) {
+            lo[idim] = Real(1.2)*amrex::Random() - Real(0.1);
+            hi[idim] = lo[idim] + len*amrex::Random();
+        }
+        const EB2::IFBounds b = f.bounds(lo, hi);
+        bool ok = b.lo <= b.hi;
+        for (int m = 0; m < 16; ++m) {
+            RealArray p;
+            for (int idim = 0; idim < 3; ++idim) {
+                const Real s = (m < 8) ? Real((m >> idim) & 1) : amrex::Random();
+                p[idim] = lo[idim] + s*(hi[idim]-lo[idim]);
+            }
+            const Real v = f(p);
+            ok = ok && (b.lo <= v) && (v <= b.hi);
+        }
+        if (!ok) { ++nbad; }
+    }
+    ParallelDescriptor::ReduceLongSum(nbad);
+    return nbad;
+}
+
+// Writes a sphere to an ASCII and a binary STL file, and checks that both
+// are read, the inside test, the distance with the bounding volume
+// hierarchy, and the bounds of STLIF.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int nrefine = 3;
+        int npoints = 4000;
+        int nboxes = 2000;
+        {
+            ParmParse pp;
+            pp.query("nrefine", nrefine);
+            pp.query("npoints", npoints);
+            pp.query("nboxes", nboxes);
+        }
+
+        const auto tris = makeSphere(nrefine);
+        if (ParallelDescriptor::IOProcessor()) {
+            writeAsciiSTL("sphere_ascii.stl", tris);
+            writeBinarySTL("sphere_binary.stl", tris);
+        }
+        ParallelDescriptor::Barrier();
+
+        const int ntri = static_cast<int>(tris.size());
+
+        STLtools ascii, binary, winding;
+        ascii.read_stl_file("sphere_ascii.stl");
+        binary.read_stl_file("sphere_binary.stl");
+        winding.setUseWindingNumber(true);
+        winding.read_binary_stl_file("sphere_binary.stl");
+        amrex::Print() << "triangles " << ntri << ", read from the ASCII file "
+                       << ascii.getNumTriangles() << ", from the binary file "
+                       << binary.getNumTriangles() << "\n";
+        AMREX_ALWAYS_ASSERT(ascii.getNumTriangles() == ntri &&
+                            binary.getNumTriangles() == ntri &&
+                            winding.getNumTriangles() == ntri);
+
+        const Long nbad_ascii = checkQuery(ascii, npoints);
+        const Long nbad_binary = checkQuery(binary, npoints);
+        const Long nbad_winding = checkQuery(winding, npoints);
+        amrex::Print() << "wrong queries: ASCII " << nbad_ascii << ", binary " << nbad_binary
+                       << ", winding number " << nbad_winding << "\n";
+        AMREX_ALWAYS_ASSERT(nbad_ascii == 0 && nbad_binary == 0 && nbad_winding == 0);
+
+        Long nbad_bounds = 0;
+        for (bool inside : {false, true}) {
+            for (Real max_distance : {std::numeric_limits<Real>::max(), Real(0.05)}) {
+                EB2::STLIF f(ascii, inside, max_distance);
+                nbad_bounds += checkBounds(f, nboxes);
+            }
+        }
+        amrex::Print() << "wrong bounds " << nbad_bounds << "\n";
+        AMREX_ALWAYS_ASSERT(nbad_bounds == 0);
+    }
+    amrex::Finalize();
+}
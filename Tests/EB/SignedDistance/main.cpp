@@ -0,0 +1,141 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBSignedDistance.H>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+    const Real r_big = 0.25;
+    const Real r_small = 0.06;
+    const RealArray c_big{AMREX_D_DECL(0.5,0.5,0.5)};
+    const RealArray c_small{AMREX_D_DECL(0.15,0.15,0.15)};
+}
+
+// The fluid is outside of a big sphere and a small one at x = 0.15+x_small.
+static auto makeShop (Real x_small)
+{
+    EB2::SphereIF big(r_big, c_big, false);
+    EB2::SphereIF small(r_small, c_small, false);
+    return EB2::makeShop(EB2::makeUnion(big, EB2::translate(small, {AMREX_D_DECL(x_small,0.,0.)})));
+}
+
+// Exact signed distance, positive in the fluid.  The spheres are apart, so
+// this is the smaller one of the distances to the two spheres.
+static Real exactDistance (const RealArray& x, Real x_small)
+{
+    Real d2_big = 0.0, d2_small = 0.0;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        Real xs = c_small[idim] + ((idim == 0) ? x_small : 0.0);
+        d2_big += (x[idim]-c_big[idim])*(x[idim]-c_big[idim]);
+        d2_small += (x[idim]-xs)*(x[idim]-xs);
+    }
+    return std::min(std::sqrt(d2_big)-r_big, std::sqrt(d2_small)-r_small);
+}
+
+// Checks the distance against the exact one.  Within the band, it has to
+// be first order accurate.  Away from it, it has to be +/-band_width.
+static void checkDistance (const EBSignedDistance& sd, const Geometry& geom, Real x_small)
+{
+    const Real band = sd.bandWidth();
+    const auto dx = geom.CellSizeArray();
+    const auto problo = geom.ProbLoArray();
+    Real err = 0.0;
+    Long nfar = 0;
+    for (MFIter mfi(sd.distance()); mfi.isValid(); ++mfi) {
+        auto const& d = sd.distance().const_array(mfi);
+        amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k)
+        {
+            IntVect iv(AMREX_D_DECL(i,j,k));
+            RealArray x;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                x[idim] = problo[idim] + iv[idim]*dx[idim];
+            }
+            const Real e = exactDistance(x, x_small);
+            if (std::abs(e) < band - 2.*dx[0]) {
+                err = std::max(err, std::abs(d(i,j,k)-e));
+            } else if (std::abs(e) > band + 2.*dx[0]) {
+                if (d(i,j,k) != std::copysign(band, e)) { ++nfar; }
+            }
+        });
+    }
+    ParallelDescriptor::ReduceRealMax(err);
+    ParallelDescriptor::ReduceLongSum(nfar);
+
+    amrex::Print() << "  max error in the band / dx = " << err/dx[0]
+                   << ", wrong nodes away from the band " << nfar
+                   << ", rounds of sweeps " << sd.numRounds() << "\n";
+
+    AMREX_ALWAYS_ASSERT(err < dx[0] && nfar == 0);
+}
+
+// Checks EBSignedDistance against the exact distance to two spheres, and
+// checks that its update after EB2::Update gives the same distance as a
+// new EBSignedDistance.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        Real band_width = 0.15;
+        int nsteps = 2;
+        Real dx = 0.03;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("band_width", band_width);
+            pp.query("nsteps", nsteps);
+            pp.query("dx", dx);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::Build(makeShop(0.0), geom, 0, 0);
+        const EB2::Level& eb_level = EB2::IndexSpace::top().getLevel(geom);
+
+        EBSignedDistance sd(ba, dm, band_width);
+        sd.update(eb_level);
+        amrex::Print() << "initial\n";
+        checkDistance(sd, geom, 0.0);
+
+        for (int step = 1; step <= nsteps; ++step)
+        {
+            const Real x = step*dx;
+            EB2::Update(makeShop(x));
+            sd.update(eb_level);
+            amrex::Print() << "step " << step << "\n";
+            checkDistance(sd, geom, x);
+
+            EBSignedDistance sd_ref(ba, dm, band_width);
+            sd_ref.update(eb_level);
+
+            MultiFab diff(sd.distance().boxArray(), dm, 1, 0);
+            MultiFab::Copy(diff, sd.distance(), 0, 0, 1, 0);
+            MultiFab::Subtract(diff, sd_ref.distance(), 0, 0, 1, 0);
+            const Real d = diff.norm0();
+            amrex::Print() << "  max diff from a new EBSignedDistance " << d << "\n";
+            AMREX_ALWAYS_ASSERT(d == 0.0);
+        }
+
+        // Nothing has changed, so there is nothing to sweep.
+        sd.update(eb_level);
+        AMREX_ALWAYS_ASSERT(sd.numRounds() == 0);
+    }
+    amrex::Finalize();
+}
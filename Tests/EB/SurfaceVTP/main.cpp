@@ -0,0 +1,170 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_WriteEBSurface.H>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace amrex;
+
+namespace {
+    struct Totals
+    {
+        Long npoints = 0;
+        Long npolys = 0;
+    };
+}
+
+static std::string readFile (std::string const& name)
+{
+    std::ifstream ifs(name, std::ios::binary);
+    if (!ifs.good()) { amrex::FileOpenFailed(name); }
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+// The values of all the attributes name="..." in s, in order
+static std::vector<std::string> attributes (std::string const& s, std::string const& name)
+{
+    std::vector<std::string> r;
+    const std::string key = " " + name + "=\"";
+    for (auto pos = s.find(key); pos != std::string::npos; pos = s.find(key, pos)) {
+        pos += key.size();
+        const auto end = s.find('"', pos);
+        r.push_back(s.substr(pos, end-pos));
+    }
+    return r;
+}
+
+// Checks one .vtp file written by WriteEBSurfaceVTP: the offsets in the
+// header must be where the size of each appended block is, the blocks must
+// follow each other without gaps, and their sizes must match the numbers
+// of points and polygons of their piece.
+static bool checkVTP (std::string const& name, Totals& totals)
+{
+    const std::string s = readFile(name);
+    const std::string marker = "<AppendedData encoding=\"raw\">\n_";
+    const auto mpos = s.find(marker);
+    if (mpos == std::string::npos) { return false; }
+    const std::string header = s.substr(0, mpos);
+    const char* data = s.data() + mpos + marker.size();
+    const std::size_t data_size = s.size() - mpos - marker.size();
+
+    const auto offsets = attributes(header, "offset");
+    const auto points = attributes(header, "NumberOfPoints");
+    const auto polys = attributes(header, "NumberOfPolys");
+    if (points.size() != polys.size()) { return false; }
+
+    // An empty file has a single piece without data.
+    std::size_t npieces = points.size();
+    if (npieces == 1 && points[0] == "0") { npieces = 0; }
+    if (offsets.size() != 3*npieces) { return false; }
+
+    bool ok = true;
+    std::size_t pos = 0;
+    for (std::size_t ip = 0; ip < npieces; ++ip)
+    {
+        const Long np = std::stol(points[ip]);
+        const Long npoly = std::stol(polys[ip]);
+        std::uint64_t nbytes[3];
+        for (int j = 0; j < 3; ++j) {
+            const std::size_t off = std::stoul(offsets[3*ip+j]);
+            ok = ok && (off == pos) && (pos + sizeof(std::uint64_t) <= data_size);
+            if (!ok) { return false; }
+            std::memcpy(&nbytes[j], data+pos, sizeof(std::uint64_t));
+            pos += sizeof(std::uint64_t) + nbytes[j];
+            if (pos > data_size) { return false; }
+        }
+        ok = ok && nbytes[0] == 3*sizeof(float)*np && nbytes[2] == sizeof(int)*npoly;
+
+        // The last polygon ends at the end of the connectivity.
+        int last_offset;
+        std::memcpy(&last_offset, data + pos - sizeof(int), sizeof(int));
+        ok = ok && static_cast<std::uint64_t>(last_offset)*sizeof(int) == nbytes[1];
+
+        totals.npoints += np;
+        totals.npolys += npoly;
+    }
+
+    ok = ok && s.substr(mpos + marker.size() + pos) == "\n</AppendedData>\n</VTKFile>\n";
+    return ok;
+}
+
+// Checks all the files listed in prefix.pvtp.
+static bool checkPVTP (std::string const& prefix, Totals& totals)
+{
+    const auto sources = attributes(readFile(prefix + ".pvtp"), "Source");
+    bool ok = !sources.empty();
+    for (auto const& src : sources) {
+        const bool r = checkVTP(src, totals);
+        if (!r) { amrex::Print() << "  bad file " << src << "\n"; }
+        ok = ok && r;
+    }
+    amrex::Print() << prefix << ": " << sources.size() << " file(s), "
+                   << totals.npoints << " points, " << totals.npolys << " polygons\n";
+    return ok;
+}
+
+// Writes the surface of a sphere with WriteEBSurfaceVTP into different
+// numbers of files, and checks the layout of the appended data of every
+// file.  The pieces of all the processes have to be there every time.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({0.,0.,0.}, {1.,1.,1.});
+            Array<int,AMREX_SPACEDIM> is_periodic{0,0,0};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::SphereIF sphere(0.3, {0.5,0.5,0.5}, false);
+        EB2::Build(EB2::makeShop(sphere), geom, 0, 0);
+        auto factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::full);
+
+        const int nprocs = ParallelDescriptor::NProcs();
+        bool ok = true;
+        Totals ref;
+        for (int nfiles : {1, 2, nprocs+1})
+        {
+            const std::string prefix = "sphere_nfiles" + std::to_string(nfiles);
+            WriteEBSurfaceVTP(prefix, ba, dm, geom, factory.get(), nfiles);
+            ParallelDescriptor::Barrier();
+
+            if (ParallelDescriptor::IOProcessor()) {
+                Totals totals;
+                ok = checkPVTP(prefix, totals) && ok;
+                if (nfiles == 1) {
+                    ref = totals;
+                    ok = ok && ref.npolys > 0;
+                } else {
+                    ok = ok && totals.npoints == ref.npoints && totals.npolys == ref.npolys;
+                }
+            }
+        }
+
+        int iok = ok;
+        ParallelDescriptor::Bcast(&iok, 1, ParallelDescriptor::IOProcessorNumber());
+        AMREX_ALWAYS_ASSERT(iok);
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,164 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EB2_IF_UnionList.H>
+#include <AMReX_EBFabFactory.H>
+
+#include <algorithm>
+#include <memory>
+
+using namespace amrex;
+
+namespace {
+    // Eight spheres far enough apart for the faces to have at most two
+    // cuts, but with overlapping bounding boxes
+    const Real radii[8] = {0.15, 0.2, 0.18, 0.2, 0.16, 0.17, 0.19, 0.2};
+    const RealArray centers[8] = {{AMREX_D_DECL(0.25,0.25,0.25)}, {AMREX_D_DECL(0.75,0.25,0.25)},
+                                  {AMREX_D_DECL(0.25,0.75,0.25)}, {AMREX_D_DECL(0.75,0.75,0.25)},
+                                  {AMREX_D_DECL(0.25,0.25,0.75)}, {AMREX_D_DECL(0.75,0.25,0.75)},
+                                  {AMREX_D_DECL(0.25,0.75,0.75)}, {AMREX_D_DECL(0.75,0.75,0.75)}};
+}
+
+static Vector<EB2::SphereIF> makeSpheres ()
+{
+    Vector<EB2::SphereIF> r;
+    for (int i = 0; i < 8; ++i) {
+        r.emplace_back(radii[i], centers[i], false);
+    }
+    return r;
+}
+
+static auto makeNestedUnion (Vector<EB2::SphereIF> const& s)
+{
+    return EB2::makeUnion(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7]);
+}
+
+// Builds the EB of the shop and returns its factory.  The index space is
+// popped by the caller after the factory is gone.
+template <class S>
+static std::unique_ptr<EBFArrayBoxFactory>
+build (S const& shop, Geometry const& geom, BoxArray const& ba, DistributionMapping const& dm)
+{
+    EB2::Build(shop, geom, 0, 0);
+    return makeEBFabFactory(geom, ba, dm, {AMREX_D_DECL(2,2,2)}, EBSupport::full);
+}
+
+static Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), 0);
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), 0);
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), 0);
+    return d.norm0();
+}
+
+// Number of cells whose flags differ
+static Long numFlagDiffs (const FabArray<EBCellFlagFab>& a, const FabArray<EBCellFlagFab>& b)
+{
+    Long r = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        auto const& x = a.const_array(mfi);
+        auto const& y = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k)
+        {
+            if (x(i,j,k).getValue() != y(i,j,k).getValue()) { ++r; }
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(r);
+    return r;
+}
+
+// Checks the flags and volume fractions of f against those of ref.  The
+// volume fractions have to be within tol.
+static bool compare (EBFArrayBoxFactory const& f, EBFArrayBoxFactory const& ref,
+                     Real tol, std::string const& name)
+{
+    const Long nflags = numFlagDiffs(f.getMultiEBCellFlagFab(), ref.getMultiEBCellFlagFab());
+    const Real dvol = maxDiff(f.getVolFrac(), ref.getVolFrac());
+    amrex::Print() << name << ": flag diffs " << nflags << ", max volfrac diff " << dvol << "\n";
+    return nflags == 0 && dvol <= tol;
+}
+
+// Checks that a UnionList of spheres has the same EB as the nested union of
+// the same spheres, with the bounding boxes found from the bounds of the
+// spheres and with boxes given by the caller, and when the union is
+// rotated, which GeometryShop cannot prune.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        Real volfrac_tol = 1.e-9;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("volfrac_tol", volfrac_tol);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        const auto spheres = makeSpheres();
+        const Real dx = geom.CellSize(0);
+
+        // The list gives outside_value where no sphere is near, so the
+        // function differs from the nested union away from the surface,
+        // and the intercepts can differ by round-off.
+        auto list = std::make_shared<EB2::UnionList<EB2::SphereIF> >
+            (spheres, RealBox({AMREX_D_DECL(-0.1,-0.1,-0.1)}, {AMREX_D_DECL(1.1,1.1,1.1)}));
+        AMREX_ALWAYS_ASSERT(list->numActiveObjects() == 8);
+
+        // With boxes that are several cells larger than the spheres, the
+        // points used for the intercepts see the same spheres.
+        Vector<RealBox> boxes;
+        for (int i = 0; i < 8; ++i) {
+            RealArray lo, hi;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                lo[idim] = centers[i][idim] - radii[i] - 4.*dx;
+                hi[idim] = centers[i][idim] + radii[i] + 4.*dx;
+            }
+            boxes.emplace_back(lo, hi);
+        }
+        auto list_boxes = std::make_shared<EB2::UnionList<EB2::SphereIF> >(spheres, boxes);
+
+        bool ok = true;
+        {
+            auto ref = build(EB2::makeShop(makeNestedUnion(spheres)), geom, ba, dm);
+            auto a = build(EB2::makeShop(list->implicitFunction(), list), geom, ba, dm);
+            auto b = build(EB2::makeShop(list_boxes->implicitFunction(), list_boxes), geom, ba, dm);
+            ok = compare(*a, *ref, volfrac_tol, "union list") && ok;
+            ok = compare(*b, *ref, 0.0, "union list with grown boxes") && ok;
+            b.reset();
+            a.reset();
+            ref.reset();
+            for (int i = 0; i < 3; ++i) { EB2::IndexSpace::pop(); }
+        }
+
+        {
+            const Real angle = 0.2;
+            const int dir = AMREX_SPACEDIM-1;
+            auto ref = build(EB2::makeShop(EB2::rotate(makeNestedUnion(spheres), angle, dir)),
+                             geom, ba, dm);
+            auto a = build(EB2::makeShop(EB2::rotate(list->implicitFunction(), angle, dir), list),
+                           geom, ba, dm);
+            ok = compare(*a, *ref, volfrac_tol, "rotated union list") && ok;
+            a.reset();
+            ref.reset();
+            for (int i = 0; i < 2; ++i) { EB2::IndexSpace::pop(); }
+        }
+
+        AMREX_ALWAYS_ASSERT(ok);
+    }
+    amrex::Finalize();
+}
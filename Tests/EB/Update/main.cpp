@@ -0,0 +1,181 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiCutFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EBFArrayBox.H>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+// A sphere at x = 0.35+x_sphere inside a cylinder, or a circle in 2D.  They
+// are far enough apart for the coarse level to be made by coarsening.
+static auto makeShop (Real x_sphere)
+{
+#if (AMREX_SPACEDIM == 3)
+    EB2::CylinderIF outer(0.45, 2, {0.5,0.5,0.5}, true);
+#else
+    EB2::SphereIF outer(0.45, {0.5,0.5}, true);
+#endif
+    EB2::SphereIF sph(0.12, {AMREX_D_DECL(0.35,0.35,0.35)}, false);
+    return EB2::makeShop(EB2::makeUnion(outer, EB2::translate(sph, {AMREX_D_DECL(x_sphere,0.,0.)})));
+}
+
+static Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    const int ng = std::min(a.nGrow(), b.nGrow());
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), ng);
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), ng);
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), ng);
+    return d.norm0(0, ng);
+}
+
+// The boxes with data have to be the same too.
+static Real maxDiff (const MultiCutFab& a, const MultiCutFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a.data()); mfi.isValid(); ++mfi) {
+        if (a.ok(mfi) != b.ok(mfi)) {
+            r = std::numeric_limits<Real>::max();
+        } else if (a.ok(mfi)) {
+            auto const& x = a.const_array(mfi);
+            auto const& y = b.const_array(mfi);
+            amrex::LoopOnCpu(mfi.fabbox(), a.nComp(), [&] (int i, int j, int k, int n)
+            {
+                r = std::max(r, std::abs(x(i,j,k,n)-y(i,j,k,n)));
+            });
+        }
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+// Number of cells whose flags differ, plus the number of boxes whose type differs
+static Long numFlagDiffs (const FabArray<EBCellFlagFab>& a, const FabArray<EBCellFlagFab>& b)
+{
+    Long r = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        if (a[mfi].getType() != b[mfi].getType()) { ++r; }
+        auto const& x = a.const_array(mfi);
+        auto const& y = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k)
+        {
+            if (x(i,j,k).getValue() != y(i,j,k).getValue()) { ++r; }
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(r);
+    return r;
+}
+
+// Moves a sphere with EB2::Update, and checks that the factory made before
+// the moves has the same data as the one of a fresh EB2::Build at the new
+// position, and that a MultiFab made before the moves sees the new flags.
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int max_coarsening_level = 1;
+        int nsteps = 3;
+        Real dx = 0.02;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+            pp.query("nsteps", nsteps);
+            pp.query("dx", dx);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::Build(makeShop(0.0), geom, 0, max_coarsening_level);
+        AMREX_ALWAYS_ASSERT(EB2::IndexSpace::top().coarsestDomain()
+                            == amrex::coarsen(geom.Domain(), 1 << max_coarsening_level));
+
+        auto factory = makeEBFabFactory(geom, ba, dm, {AMREX_D_DECL(2,2,2)}, EBSupport::full);
+        MultiFab phi(ba, dm, 1, 1, MFInfo(), *factory);
+
+        const Geometry cgeom = amrex::coarsen(geom, 2);
+        const BoxArray cba = amrex::coarsen(ba, 2);
+
+        for (int step = 1; step <= nsteps; ++step)
+        {
+            const Real x = step*dx;
+            EB2::Update(makeShop(x));
+
+            // the coarse level made again from the updated finest level
+            const Box coarsest = EB2::IndexSpace::top().coarsestDomain();
+            MultiFab cvolfrac(cba, dm, 1, 0);
+            if (max_coarsening_level > 0) {
+                EB2::IndexSpace::top().getLevel(cgeom).fillVolFrac(cvolfrac, cgeom);
+            }
+
+            EB2::Build(makeShop(x), geom, 0, max_coarsening_level);
+            auto ref = makeEBFabFactory(geom, ba, dm, {AMREX_D_DECL(2,2,2)}, EBSupport::full);
+
+            AMREX_ALWAYS_ASSERT(coarsest == EB2::IndexSpace::top().coarsestDomain());
+            MultiFab cvolfrac_ref(cba, dm, 1, 0);
+            if (max_coarsening_level > 0) {
+                EB2::IndexSpace::top().getLevel(cgeom).fillVolFrac(cvolfrac_ref, cgeom);
+            }
+
+            // The cut cell data are made again by Update, so they have to
+            // be fetched again from the factory.
+            Real d = maxDiff(factory->getVolFrac(), ref->getVolFrac());
+            d = std::max(d, maxDiff(factory->getLevelSet(), ref->getLevelSet()));
+            d = std::max(d, maxDiff(factory->getCentroid(), ref->getCentroid()));
+            d = std::max(d, maxDiff(factory->getBndryCent(), ref->getBndryCent()));
+            d = std::max(d, maxDiff(factory->getBndryNormal(), ref->getBndryNormal()));
+            d = std::max(d, maxDiff(factory->getBndryArea(), ref->getBndryArea()));
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                d = std::max(d, maxDiff(*factory->getAreaFrac()[idim], *ref->getAreaFrac()[idim]));
+                d = std::max(d, maxDiff(*factory->getFaceCent()[idim], *ref->getFaceCent()[idim]));
+                d = std::max(d, maxDiff(*factory->getEdgeCent()[idim], *ref->getEdgeCent()[idim]));
+            }
+            const Real dc = maxDiff(cvolfrac, cvolfrac_ref);
+
+            const auto& flags = factory->getMultiEBCellFlagFab();
+            const auto& flags_ref = ref->getMultiEBCellFlagFab();
+            const Long nflags = numFlagDiffs(flags, flags_ref);
+
+            // The fabs of phi point to the cell flags of the factory, which
+            // have been refilled in place.  Their own FabType is that of
+            // the initial geometry.
+            Long nphi = 0;
+            for (MFIter mfi(phi); mfi.isValid(); ++mfi) {
+                auto const& ebfab = static_cast<EBFArrayBox const&>(phi[mfi]);
+                const Box& bx = amrex::enclosedCells(ebfab.box());
+                if (&ebfab.getEBCellFlagFab() != &flags[mfi] ||
+                    ebfab.getEBCellFlagFab().getType(bx) != flags_ref[mfi].getType(bx)) {
+                    ++nphi;
+                }
+            }
+            ParallelDescriptor::ReduceLongSum(nphi);
+
+            amrex::Print() << "step " << step << ": max diff " << d << ", coarse volfrac diff "
+                           << dc << ", flag diffs " << nflags << ", stale fabs " << nphi << "\n";
+
+            AMREX_ALWAYS_ASSERT(d == 0.0 && dc == 0.0 && nflags == 0 && nphi == 0);
+
+            ref.reset();
+            EB2::IndexSpace::pop();
+        }
+    }
+    amrex::Finalize();
+}
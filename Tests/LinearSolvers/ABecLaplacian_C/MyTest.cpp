@@ -1,12 +1,37 @@
 #include "MyTest.H"
 
 #include <AMReX_MLABecLaplacian.H>
+#include <AMReX_MLFGMRESSolver.H>
 #include <AMReX_MLPoisson.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_MultiFabUtil.H>
 
 using namespace amrex;
 
+namespace {
+    void setFaceBCoeffs (MLABecLaplacian& mlabec, int amrlev, MultiFab const& bcoef,
+                         Geometry const& geom)
+    {
+        Array<MultiFab,AMREX_SPACEDIM> face_bcoef;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            const BoxArray& ba = amrex::convert(bcoef.boxArray(),
+                                                IntVect::TheDimensionVector(idim));
+            face_bcoef[idim].define(ba, bcoef.DistributionMap(), 1, 0);
+        }
+        amrex::average_cellcenter_to_face(GetArrOfPtrs(face_bcoef), bcoef, geom);
+        mlabec.setBCoeffs(amrlev, amrex::GetArrOfConstPtrs(face_bcoef));
+    }
+
+    Real maxDiff (MultiFab const& a, MultiFab const& b)
+    {
+        MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), 0);
+        MultiFab::Copy(d, a, 0, 0, a.nComp(), 0);
+        MultiFab::Subtract(d, b, 0, 0, a.nComp(), 0);
+        return d.norm0(0, a.nComp(), IntVect(0));
+    }
+}
+
 MyTest::MyTest ()
 {
     readParameters();
@@ -18,6 +43,8 @@ MyTest::solve ()
 {
     if (prob_type == 1) {
         solvePoisson();
+    } else if (prob_type == 2 && nrhs > 1) {
+        solveABecLaplacianBatched();
     } else if (prob_type == 2) {
         solveABecLaplacian();
     } else if (prob_type == 3) {
@@ -34,6 +61,9 @@ MyTest::solvePoisson ()
     info.setAgglomeration(agglomeration);
     info.setConsolidation(consolidation);
     info.setMaxCoarseningLevel(max_coarsening_level);
+    info.setHaloDepth(halo_depth);
+    info.setChebyshevSmoother(chebyshev);
+    info.setChebyshevDegree(chebyshev_degree);
 
     const Real tol_rel = 1.e-10;
     const Real tol_abs = 0.0;
@@ -47,13 +77,9 @@ MyTest::solvePoisson ()
 
         mlpoisson.setMaxOrder(linop_maxorder);
 
-        // This is a 3d problem with Dirichlet BC
-        mlpoisson.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet)},
-                              {AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet)});
+        // This is a 3d problem with Dirichlet BC, or a periodic one
+        const LinOpBCType bc = periodic ? LinOpBCType::Periodic : LinOpBCType::Dirichlet;
+        mlpoisson.setDomainBC({AMREX_D_DECL(bc,bc,bc)}, {AMREX_D_DECL(bc,bc,bc)});
 
         for (int ilev = 0; ilev < nlevels; ++ilev)
         {
@@ -65,6 +91,8 @@ MyTest::solvePoisson ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setBottomSolver(bottom_solver);
+        mlmg.setMixedPrecision(mixed_precision);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -78,6 +106,9 @@ MyTest::solvePoisson ()
 #endif
 
         mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!check_bottom_solver || mlmg.getBottomSolver() == bottom_solver,
+                                         "MyTest: MLMG did not use the requested bottom solver");
     }
     else
     {
@@ -87,13 +118,9 @@ MyTest::solvePoisson ()
 
             mlpoisson.setMaxOrder(linop_maxorder);
 
-            // This is a 3d problem with Dirichlet BC
-            mlpoisson.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                                LinOpBCType::Dirichlet,
-                                                LinOpBCType::Dirichlet)},
-                                  {AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                                LinOpBCType::Dirichlet,
-                                                LinOpBCType::Dirichlet)});
+            // This is a 3d problem with Dirichlet BC, or a periodic one
+            const LinOpBCType bc = periodic ? LinOpBCType::Periodic : LinOpBCType::Dirichlet;
+            mlpoisson.setDomainBC({AMREX_D_DECL(bc,bc,bc)}, {AMREX_D_DECL(bc,bc,bc)});
 
             if (ilev > 0) {
                 mlpoisson.setCoarseFineBC(&solution[ilev-1], ref_ratio);
@@ -106,6 +133,8 @@ MyTest::solvePoisson ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setBottomSolver(bottom_solver);
+            mlmg.setMixedPrecision(mixed_precision);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -119,6 +148,9 @@ MyTest::solvePoisson ()
 #endif
 
             mlmg.solve({&solution[ilev]}, {&rhs[ilev]}, tol_rel, tol_abs);
+
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!check_bottom_solver || mlmg.getBottomSolver() == bottom_solver,
+                                             "MyTest: MLMG did not use the requested bottom solver");
         }
     }
 }
@@ -131,6 +163,9 @@ MyTest::solveABecLaplacian ()
     info.setConsolidation(consolidation);
     info.setSemicoarsening(semicoarsening);
     info.setMaxCoarseningLevel(max_coarsening_level);
+    info.setHaloDepth(halo_depth);
+    info.setChebyshevSmoother(chebyshev);
+    info.setChebyshevDegree(chebyshev_degree);
     info.setMaxSemicoarseningLevel(max_semicoarsening_level);
 
     const Real tol_rel = 1.e-10;
@@ -182,6 +217,7 @@ MyTest::solveABecLaplacian ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -194,7 +230,19 @@ MyTest::solveABecLaplacian ()
         }
 #endif
 
-        mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+        mlmg.setAMGSetupReuse(amg_setup_reuse);
+
+        if (use_fgmres) {
+            // MLMG V-cycles as the preconditioner of FGMRES, or GCR with fgmres.type = gcr
+            MLFGMRESSolver fgmres(mlmg, mlabec);
+            fgmres.setVerbose(verbose);
+            fgmres.setMaxIter(max_iter);
+            fgmres.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+        } else {
+            mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+        }
+
+        resolveABecLaplacian(mlabec, mlmg, info, tol_rel, tol_abs);
     }
     else
     {
@@ -239,6 +287,7 @@ MyTest::solveABecLaplacian ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -267,6 +316,124 @@ MyTest::solveABecLaplacian ()
     }
 }
 
+// Solve nrhs systems with the same operator at once.  Right-hand side 0 is the
+// original one, and right-hand side n > 0 is 1.e-3*bcoef times right-hand side
+// n-1 minus its mean.  Each component has to converge relative to its own scale.
+void
+MyTest::solveABecLaplacianBatched ()
+{
+    LPInfo info;
+    info.setAgglomeration(agglomeration);
+    info.setConsolidation(consolidation);
+    info.setMaxCoarseningLevel(max_coarsening_level);
+
+    const Real tol_rel = 1.e-10;
+    const Real tol_abs = 0.0;
+
+    const int nlevels = geom.size();
+
+    MLABecLaplacian mlabec(geom, grids, dmap, info, {}, nrhs);
+
+    mlabec.setMaxOrder(linop_maxorder);
+
+    mlabec.setDomainBC({AMREX_D_DECL(LinOpBCType::Neumann,
+                                     LinOpBCType::Neumann,
+                                     LinOpBCType::Neumann)},
+                       {AMREX_D_DECL(LinOpBCType::Neumann,
+                                     LinOpBCType::Neumann,
+                                     LinOpBCType::Neumann)});
+
+    Vector<MultiFab> bsol(nlevels);
+    Vector<MultiFab> brhs(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        bsol[ilev].define(grids[ilev], dmap[ilev], nrhs, 1);
+        brhs[ilev].define(grids[ilev], dmap[ilev], nrhs, 0);
+        bsol[ilev].setVal(0.0);
+        MultiFab::Copy(brhs[ilev], rhs[ilev], 0, 0, 1, 0);
+        for (int n = 1; n < nrhs; ++n) {
+            MultiFab::Copy(brhs[ilev], brhs[ilev], n-1, n, 1, 0);
+            MultiFab::Multiply(brhs[ilev], bcoef[ilev], 0, n, 1, 0);
+            brhs[ilev].mult(Real(1.e-3), n, 1);
+        }
+
+        mlabec.setLevelBC(ilev, nullptr);
+    }
+
+    // Remove the mean of the new right-hand sides so that, like the original one,
+    // they are nearly compatible with the Neumann BC.
+    for (int n = 1; n < nrhs; ++n) {
+        const Real avg = brhs[0].sum(n) / grids[0].d_numPts();
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            brhs[ilev].plus(-avg, n, 1, 0);
+        }
+    }
+
+    mlabec.setScalars(ascalar, bscalar);
+
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        mlabec.setACoeffs(ilev, acoef[ilev]);
+
+        Array<MultiFab,AMREX_SPACEDIM> face_bcoef;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            const BoxArray& ba = amrex::convert(bcoef[ilev].boxArray(),
+                                                IntVect::TheDimensionVector(idim));
+            face_bcoef[idim].define(ba, bcoef[ilev].DistributionMap(), 1, 0);
+        }
+        amrex::average_cellcenter_to_face(GetArrOfPtrs(face_bcoef),
+                                          bcoef[ilev], geom[ilev]);
+        mlabec.setBCoeffs(ilev, amrex::GetArrOfConstPtrs(face_bcoef));
+    }
+
+    MLMG mlmg(mlabec);
+    mlmg.setMaxIter(max_iter);
+    mlmg.setMaxFmgIter(max_fmg_iter);
+    mlmg.setVerbose(verbose);
+    mlmg.setBottomVerbose(bottom_verbose);
+    mlmg.setBottomSolver(bottom_solver);
+    mlmg.setIndependentComponents(independent_comps);
+
+    mlmg.solve(GetVecOfPtrs(bsol), GetVecOfConstPtrs(brhs), tol_rel, tol_abs);
+
+    // relative residual of each component
+    Vector<MultiFab> bres(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        bres[ilev].define(grids[ilev], dmap[ilev], nrhs, 0);
+    }
+    mlmg.compResidual(GetVecOfPtrs(bres), GetVecOfPtrs(bsol), GetVecOfConstPtrs(brhs));
+    for (int n = 0; n < nrhs; ++n)
+    {
+        Real resnorm = 0.0;
+        Real rhsnorm = 0.0;
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            resnorm = std::max(resnorm, bres[ilev].norm0(n));
+            rhsnorm = std::max(rhsnorm, brhs[ilev].norm0(n));
+        }
+        amrex::Print() << "MyTest: component " << n << " resid/bnorm = "
+                       << resnorm/rhsnorm << "\n";
+        // The composite and the per-level residual norms differ slightly.
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!independent_comps || resnorm <= Real(10.)*tol_rel*rhsnorm,
+                                         "MyTest: component did not converge to its own tolerance");
+    }
+
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        MultiFab::Copy(solution[ilev], bsol[ilev], 0, 0, 1, 0);
+    }
+
+    // Since this problem has Neumann BC, solution + constant is also a
+    // solution.  So we are going to shift the solution by a constant
+    // for comparison with the "exact solution".
+    const Real npts = grids[0].d_numPts();
+    const Real avg1 = exact_solution[0].sum();
+    const Real avg2 = solution[0].sum();
+    const Real offset = (avg1-avg2)/npts;
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        solution[ilev].plus(offset, 0, 1, 0);
+    }
+}
+
 void
 MyTest::solveABecLaplacianInhomNeumann ()
 {
@@ -274,6 +441,9 @@ MyTest::solveABecLaplacianInhomNeumann ()
     info.setAgglomeration(agglomeration);
     info.setConsolidation(consolidation);
     info.setMaxCoarseningLevel(max_coarsening_level);
+    info.setHaloDepth(halo_depth);
+    info.setChebyshevSmoother(chebyshev);
+    info.setChebyshevDegree(chebyshev_degree);
 
     const Real tol_rel = 1.e-10;
     const Real tol_abs = 0.0;
@@ -324,6 +494,7 @@ MyTest::solveABecLaplacianInhomNeumann ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -336,7 +507,11 @@ MyTest::solveABecLaplacianInhomNeumann ()
         }
 #endif
 
+        mlmg.setAMGSetupReuse(amg_setup_reuse);
+
         mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+
+        resolveABecLaplacian(mlabec, mlmg, info, tol_rel, tol_abs);
     }
     else
     {
@@ -381,6 +556,7 @@ MyTest::solveABecLaplacianInhomNeumann ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -409,6 +585,69 @@ MyTest::solveABecLaplacianInhomNeumann ()
     }
 }
 
+// Re-solve as a time stepper would, with the same solver and slowly varying
+// coefficients on the finest level.  The previous solution is the initial guess.
+// The coefficients alternate, so that they are the original ones again after an
+// even number of re-solves.  With more than one level, the coefficients of the
+// coarsest level are then changed alone, and the coefficients of every AMR
+// level have to be the same as those of a new operator.
+void
+MyTest::resolveABecLaplacian (MLABecLaplacian& mlabec, MLMG& mlmg, LPInfo const& info,
+                              Real tol_rel, Real tol_abs)
+{
+    const int nlevels = geom.size();
+    for (int n = 0; n < n_resolve; ++n)
+    {
+        const Real fac = (n % 2 == 0) ? Real(1.01) : Real(1.0/1.01);
+        acoef[nlevels-1].mult(fac);
+        mlabec.setACoeffs(nlevels-1, acoef[nlevels-1]);
+        mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+        amrex::Print() << "MyTest: re-solve " << n+1 << ": setup time = "
+                       << mlmg.getSetupTime() << ", solve time = "
+                       << mlmg.getSolveTime() << "\n";
+    }
+
+    if (n_resolve == 0 || nlevels == 1) { return; }
+
+    acoef[0].mult(Real(1.02));
+    bcoef[0].mult(Real(1.02));
+    mlabec.setACoeffs(0, acoef[0]);
+    setFaceBCoeffs(mlabec, 0, bcoef[0], geom[0]);
+    mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+
+    // Only the coefficients are compared, so the boundary conditions do not matter.
+    MLABecLaplacian fresh(geom, grids, dmap, info);
+    fresh.setMaxOrder(linop_maxorder);
+    fresh.setDomainBC({AMREX_D_DECL(LinOpBCType::Neumann,
+                                    LinOpBCType::Neumann,
+                                    LinOpBCType::Neumann)},
+                      {AMREX_D_DECL(LinOpBCType::Neumann,
+                                    LinOpBCType::Neumann,
+                                    LinOpBCType::Neumann)});
+    fresh.setScalars(ascalar, bscalar);
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        fresh.setLevelBC(ilev, nullptr);
+        fresh.setACoeffs(ilev, acoef[ilev]);
+        setFaceBCoeffs(fresh, ilev, bcoef[ilev], geom[ilev]);
+    }
+    fresh.prepareForSolve();
+
+    // The coarser MG levels are averaged down from these.
+    Real diff = 0.0;
+    for (int amrlev = 0; amrlev < nlevels; ++amrlev) {
+        diff = std::max(diff, maxDiff(*mlabec.getACoeffs(amrlev,0), *fresh.getACoeffs(amrlev,0)));
+        const auto b = mlabec.getBCoeffs(amrlev,0);
+        const auto bfresh = fresh.getBCoeffs(amrlev,0);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            diff = std::max(diff, maxDiff(*b[idim], *bfresh[idim]));
+        }
+    }
+    amrex::Print() << "MyTest: max coefficient diff after a coarse level update = "
+                   << diff << "\n";
+    AMREX_ALWAYS_ASSERT(diff == 0.0);
+}
+
 void
 MyTest::readParameters ()
 {
@@ -421,9 +660,41 @@ MyTest::readParameters ()
     pp.query("composite_solve", composite_solve);
 
     pp.query("prob_type", prob_type);
+    pp.query("periodic", periodic);
 
     pp.query("verbose", verbose);
     pp.query("bottom_verbose", bottom_verbose);
+    std::string bottom_solver_s;
+    pp.query("bottom_solver", bottom_solver_s);
+    if (bottom_solver_s == "smoother") {
+        bottom_solver = MLMG::BottomSolver::smoother;
+    } else if (bottom_solver_s == "bicg") {
+        bottom_solver = MLMG::BottomSolver::bicgstab;
+    } else if (bottom_solver_s == "cg") {
+        bottom_solver = MLMG::BottomSolver::cg;
+    } else if (bottom_solver_s == "pipelined_bicg") {
+        bottom_solver = MLMG::BottomSolver::pipelined_bicgstab;
+    } else if (bottom_solver_s == "pipelined_cg") {
+        bottom_solver = MLMG::BottomSolver::pipelined_cg;
+    } else if (bottom_solver_s == "amg") {
+        bottom_solver = MLMG::BottomSolver::amg;
+    } else if (bottom_solver_s == "direct") {
+        bottom_solver = MLMG::BottomSolver::direct;
+    } else if (bottom_solver_s == "fft") {
+        bottom_solver = MLMG::BottomSolver::fft;
+    } else if ( ! bottom_solver_s.empty()) {
+        amrex::Abort("MyTest: unknown bottom_solver " + bottom_solver_s);
+    }
+    pp.query("check_bottom_solver", check_bottom_solver);
+    pp.query("mixed_precision", mixed_precision);
+    pp.query("halo_depth", halo_depth);
+    pp.query("chebyshev", chebyshev);
+    pp.query("chebyshev_degree", chebyshev_degree);
+    pp.query("n_resolve", n_resolve);
+    pp.query("nrhs", nrhs);
+    pp.query("independent_comps", independent_comps);
+    pp.query("amg_setup_reuse", amg_setup_reuse);
+    pp.query("use_fgmres", use_fgmres);
     pp.query("max_iter", max_iter);
     pp.query("max_fmg_iter", max_fmg_iter);
     pp.query("linop_maxorder", linop_maxorder);
@@ -469,7 +740,10 @@ MyTest::initData ()
     }
 
     RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
-    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!periodic || prob_type == 1,
+                                     "MyTest: periodic only works with prob_type = 1");
+    const int p = periodic ? 1 : 0;
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(p,p,p)};
     Geometry::Setup(&rb, 0, is_periodic.data());
     Box domain0(IntVect{AMREX_D_DECL(0,0,0)}, IntVect{AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)});
     Box domain = domain0;
@@ -3,12 +3,15 @@
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF.H>
 #include <AMReX_MacProjector.H>
+#include <AMReX_MLEBABecLap.H>
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_TagBox.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_ParmParse.H>
 
+#include <memory>
+
 using namespace amrex;
 
 void write_plotfile(const Geometry& geom, const MultiFab& plotmf, int regtest)
@@ -57,6 +60,7 @@ int main (int argc, char* argv[])
         int max_grid_size = 32;
         int use_hypre  = 0;
         int regtest   = 0;
+        int eb_cache_stencil = 0;
 
         Real obstacle_radius = 0.10;
 
@@ -69,6 +73,7 @@ int main (int argc, char* argv[])
             pp.query("max_grid_size", max_grid_size);
             pp.query("use_hypre", use_hypre);
             pp.query("regtest", regtest);
+            pp.query("eb_cache_stencil", eb_cache_stencil);
         }
 
 #ifndef AMREX_USE_HYPRE
@@ -187,6 +192,26 @@ int main (int argc, char* argv[])
         if (use_hypre)
             lp_info.setMaxCoarseningLevel(0);
 
+        auto setup_projector = [&] (MacProjector& mp)
+        {
+            // Set bottom-solver to use hypre instead of native BiCGStab
+            if (use_hypre)
+                mp.getMLMG().setBottomSolver(MLMG::BottomSolver::hypre);
+
+            // Hard-wire the boundary conditions to be Neumann on the low x-face, Dirichlet
+            // on the high x-face, and periodic in the other two directions
+            // (the first argument is for the low end, the second is for the high end)
+            mp.setDomainBC({AMREX_D_DECL(LinOpBCType::Neumann,
+                                         LinOpBCType::Periodic,
+                                         LinOpBCType::Periodic)},
+                           {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                         LinOpBCType::Periodic,
+                                         LinOpBCType::Periodic)});
+
+            mp.setVerbose(mg_verbose);
+            mp.getMLMG().setBottomVerbose(bottom_verbose);
+        };
+
         MacProjector macproj({amrex::GetArrOfPtrs(vel)},       // mac velocity
                              MLMG::Location::FaceCenter,       // Location of vel
                              {amrex::GetArrOfConstPtrs(beta)}, // beta
@@ -202,22 +227,7 @@ int main (int argc, char* argv[])
         //                      lp_info,                          // structure for passing info to the operator
         //                      {&S});                            // defines the specified RHS divergence
 
-        // Set bottom-solver to use hypre instead of native BiCGStab
-        if (use_hypre)
-            macproj.getMLMG().setBottomSolver(MLMG::BottomSolver::hypre);
-
-        // Hard-wire the boundary conditions to be Neumann on the low x-face, Dirichlet
-        // on the high x-face, and periodic in the other two directions
-        // (the first argument is for the low end, the second is for the high end)
-        macproj.setDomainBC({AMREX_D_DECL(LinOpBCType::Neumann,
-                                          LinOpBCType::Periodic,
-                                          LinOpBCType::Periodic)},
-                            {AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                          LinOpBCType::Periodic,
-                                          LinOpBCType::Periodic)});
-
-        macproj.setVerbose(mg_verbose);
-        macproj.getMLMG().setBottomVerbose(bottom_verbose);
+        setup_projector(macproj);
 
         // Define the relative tolerance
         Real reltol = 1.e-8;
@@ -232,10 +242,87 @@ int main (int argc, char* argv[])
         amrex::Print() << " The maximum grid size is " << max_grid_size                             << std::endl;
         amrex::Print() << "******************************************************************** \n" << std::endl;
 
+        // With the cut cell stencils cached, or with the compact cut cell data,
+        // the velocity is projected with the geometric operator on the dense
+        // cut cell data too.  The two operators have to agree to round-off.
+        // The solves need not have the same residuals, because the BiCGStab
+        // bottom solver amplifies the round-off differences, but they have to
+        // give the same velocity up to the solver tolerance.
+        const bool compact = EB2::CompactCutCellData();
+        const bool check_ref = eb_cache_stencil || compact;
+        std::unique_ptr<EBFArrayBoxFactory> factory_dense;
+        if (compact) {
+            AMREX_ALWAYS_ASSERT(factory.getCutCellData() != nullptr);
+            EB2::SetCompactCutCellData(false);
+            factory_dense = std::make_unique<EBFArrayBoxFactory>(eb_level, geom, grids, dmap,
+                                                                 ng_ebs, ebs);
+            EB2::SetCompactCutCellData(true);
+            AMREX_ALWAYS_ASSERT(factory_dense->getCutCellData() == nullptr);
+        }
+        EBFArrayBoxFactory const& factory_ref = compact ? *factory_dense : factory;
+
+        Array<MultiFab,AMREX_SPACEDIM> vel_ref;
+        Array<MultiFab,AMREX_SPACEDIM> beta_ref;
+        std::unique_ptr<MacProjector> macproj_ref;
+        if (check_ref) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                vel_ref[idim].define(vel[idim].boxArray(), dmap, 1, 1, MFInfo(), factory_ref);
+                MultiFab::Copy(vel_ref[idim], vel[idim], 0, 0, 1, 1);
+                beta_ref[idim].define(beta[idim].boxArray(), dmap, 1, 0, MFInfo(), factory_ref);
+                beta_ref[idim].setVal(1.0);
+            }
+            macproj_ref = std::make_unique<MacProjector>
+                (Vector<Array<MultiFab*,AMREX_SPACEDIM> >{amrex::GetArrOfPtrs(vel_ref)},
+                 MLMG::Location::FaceCenter,
+                 Vector<Array<MultiFab const*,AMREX_SPACEDIM> >{amrex::GetArrOfConstPtrs(beta_ref)},
+                 MLMG::Location::FaceCenter, MLMG::Location::CellCenter,
+                 Vector<Geometry>{geom}, lp_info);
+            setup_projector(*macproj_ref);
+            macproj_ref->project(reltol,abstol);
+        }
+
+        if (eb_cache_stencil) {
+            dynamic_cast<MLEBABecLap&>(macproj.getLinOp()).setCacheCutCellStencil(true);
+        }
+
         // Solve for phi and subtract from the velocity to make it divergence-free
         // Note that the normal velocities are at face centers (not centroids)
         macproj.project(reltol,abstol);
 
+        if (check_ref) {
+            MultiFab phi(grids, dmap, 1, 1, MFInfo(), factory);
+            MultiFab lphi(grids, dmap, 1, 0, MFInfo(), factory);
+            MultiFab lphi_ref(grids, dmap, 1, 0, MFInfo(), factory);
+            phi.setVal(0.0);
+            for (MFIter mfi(phi); mfi.isValid(); ++mfi) {
+                auto const& p = phi.array(mfi);
+                amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    p(i,j,k) = std::sin(0.37*i + 0.11*j*j + 0.7*k);
+                });
+            }
+            macproj.getMLMG().apply({&lphi}, {&phi});
+            macproj_ref->getMLMG().apply({&lphi_ref}, {&phi});
+            MultiFab::Subtract(lphi, lphi_ref, 0, 0, 1, 0);
+            const Real op_diff = lphi.norm0() / lphi_ref.norm0();
+
+            Real vel_diff = 0.0;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                MultiFab::Subtract(vel_ref[idim], vel[idim], 0, 0, 1, 0);
+                vel_diff = std::max(vel_diff, vel_ref[idim].norm0());
+            }
+            const int niters = macproj.getMLMG().getNumIters();
+            const int niters_ref = macproj_ref->getMLMG().getNumIters();
+            amrex::Print() << (eb_cache_stencil ? " Cached cut cell stencils" : "")
+                           << (compact ? " Compact cut cell data" : "")
+                           << ": relative difference of the operators "
+                           << op_diff << ", " << niters << " iterations (" << niters_ref
+                           << " with the reference operator), max difference of the velocity "
+                           << vel_diff << std::endl;
+            AMREX_ALWAYS_ASSERT(op_diff < 1.e-12 && std::abs(niters-niters_ref) <= 1 &&
+                                vel_diff < 1.e-7);
+        }
+
         // If we want to use phi elsewhere, we can pass in an array in which to return the solution
         // MultiFab phi_inout(grids, dmap, 1, 1, MFInfo(), factory);
         // macproj.project_center_vels({&phi_inout},reltol,abstol,MLMG::Location::FaceCenter);
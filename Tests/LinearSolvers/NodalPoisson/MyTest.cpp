@@ -23,18 +23,17 @@ MyTest::solve ()
     info.setSemicoarsening(semicoarsening);
     info.setMaxCoarseningLevel(max_coarsening_level);
     info.setMaxSemicoarseningLevel(max_semicoarsening_level);
+    info.setChebyshevSmoother(chebyshev);
+    info.setChebyshevDegree(chebyshev_degree);
+
+    const LinOpBCType bc = periodic ? LinOpBCType::Periodic : LinOpBCType::Dirichlet;
 
     if (composite_solve)
     {
         MLNodeLaplacian linop(geom, grids, dmap, info);
         //linop.setSmoothNumSweeps(smooth_num_sweeps);
 
-        linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                        LinOpBCType::Dirichlet,
-                                        LinOpBCType::Dirichlet)},
-                          {AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                        LinOpBCType::Dirichlet,
-                                        LinOpBCType::Dirichlet)});
+        linop.setDomainBC({AMREX_D_DECL(bc,bc,bc)}, {AMREX_D_DECL(bc,bc,bc)});
 
         for (int ilev = 0; ilev <= max_level; ++ilev) {
             linop.setSigma(ilev, sigma[ilev]);
@@ -56,6 +55,7 @@ MyTest::solve ()
             // we set the domain boundaries to exact solution and zero out
             // the interior.
             solution[ilev].setVal(0.0, interior, 0, 1, 0);
+            if (periodic) { solution[ilev].setVal(0.0); }
         }
 
         mlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), reltol, 0.0);
@@ -66,12 +66,7 @@ MyTest::solve ()
         {
             MLNodeLaplacian linop({geom[ilev]}, {grids[ilev]}, {dmap[ilev]}, info);
 
-            linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet)},
-                              {AMREX_D_DECL(LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet,
-                                            LinOpBCType::Dirichlet)});
+            linop.setDomainBC({AMREX_D_DECL(bc,bc,bc)}, {AMREX_D_DECL(bc,bc,bc)});
 
             linop.setSigma(0, sigma[ilev]); // set solver's level 0 sigma.
 
@@ -97,6 +92,7 @@ MyTest::solve ()
                 // we set the domain boundaries to exact solution and zero out
                 // the interior.
                 solution[ilev].setVal(0.0, interior, 0, 1, 0);
+                if (periodic) { solution[ilev].setVal(0.0); }
             } else {
                 // Coarse/fine boundary is Dirichlet.
                 // For fine levels, we interpolate from coarse to fine to set up
@@ -120,11 +116,34 @@ MyTest::solve ()
 void
 MyTest::compute_norms () const
 {
+    // With periodic boundaries, the solution is only known up to a constant.
+    Real offset = 0.0;
+    if (periodic) {
+        MultiFab error(solution[0].boxArray(), solution[0].DistributionMap(), 1, 0);
+        MultiFab::Copy(error, solution[0], 0, 0, 1, 0);
+        MultiFab::Subtract(error, exact_solution[0], 0, 0, 1, 0);
+        auto mask = error.OwnerMask(geom[0].periodicity());
+        offset = amrex::ReduceSum(error, *mask, 0,
+            [=] AMREX_GPU_HOST_DEVICE (Box const& bx, Array4<Real const> const& e,
+                                       Array4<int const> const& m) -> Real
+            {
+                Real r = 0.0;
+                AMREX_LOOP_3D(bx, i, j, k,
+                {
+                    if (m(i,j,k)) { r += e(i,j,k); }
+                });
+                return r;
+            });
+        ParallelDescriptor::ReduceRealSum(offset);
+        offset /= static_cast<Real>(geom[0].Domain().numPts());
+    }
+
     for (int ilev = 0; ilev <= max_level; ++ilev) {
         amrex::Print() << "Level " << ilev << "\n";
         MultiFab error(solution[ilev].boxArray(), solution[ilev].DistributionMap(), 1, 0);
         MultiFab::Copy(error, solution[ilev], 0, 0, 1, 0);
         MultiFab::Subtract(error, exact_solution[ilev], 0, 0, 1, 0);
+        error.plus(-offset, 0, 1, 0);
 
         auto mask = error.OwnerMask(geom[ilev].periodicity());
 
@@ -160,6 +179,9 @@ MyTest::readParameters ()
     pp.query("max_coarsening_level", max_coarsening_level);
     pp.query("max_semicoarsening_level", max_semicoarsening_level);
     //pp.query("smooth_num_sweeps", smooth_num_sweeps);
+    pp.query("chebyshev", chebyshev);
+    pp.query("chebyshev_degree", chebyshev_degree);
+    pp.query("periodic", periodic);
 
     pp.query("do_plots", do_plots);
     pp.query("num_trials", num_trials);
@@ -191,7 +213,7 @@ MyTest::initData ()
     sigma.resize(nlevels);
 
     RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
-    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(periodic,periodic,periodic)};
     Geometry::Setup(&rb, 0, is_periodic.data());
     Box domain0(IntVect{AMREX_D_DECL(0,0,0)}, IntVect{AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)});
     Box domain = domain0;
@@ -0,0 +1,149 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleColumnReader.H>
+
+using namespace amrex;
+
+static constexpr int NSR = 2;
+static constexpr int NSI = 1;
+static constexpr int NAR = 1;
+static constexpr int NAI = 1;
+
+using TestParticleContainer = ParticleContainer<NSR, NSI, NAR, NAI>;
+
+struct TestParams
+{
+    IntVect size;
+    int max_grid_size;
+    int num_particles;
+    int chunk_size;
+};
+
+void testColumnarIO ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    amrex::Print() << "Running columnar particle IO test \n";
+    testColumnarIO();
+
+    amrex::Finalize();
+}
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("num_particles", params.num_particles);
+    pp.get("chunk_size", params.chunk_size);
+}
+
+void testColumnarIO ()
+{
+    BL_PROFILE("testColumnarIO");
+    TestParams params;
+    get_test_params(params, "columnar");
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+
+    IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+    IntVect domain_hi(AMREX_D_DECL(params.size[0]-1,params.size[1]-1,params.size[2]-1));
+    const Box domain(domain_lo, domain_hi);
+
+    int coord = 0;
+    int is_per[AMREX_SPACEDIM];
+    for (int i = 0; i < AMREX_SPACEDIM; i++)
+        is_per[i] = 1;
+    Geometry geom(domain, &real_box, coord, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    TestParticleContainer pc(geom, dm, ba);
+
+    TestParticleContainer::ParticleInitData pdata = {{1.0, 2.0}, {3}, {4.0}, {5}};
+    pc.InitRandom(params.num_particles, 451, pdata);
+
+    WriteColumnarParticleData(pc, "plt00000", "particle0",
+                              {"a", "b", "c"}, {"i", "j"}, params.chunk_size);
+
+    // the region we want to extract
+    RealBox region;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        region.setLo(n, 0.3);
+        region.setHi(n, 0.45);
+    }
+
+    using PType = typename TestParticleContainer::SuperParticleType;
+    Long nexpected = amrex::ReduceSum(pc,
+        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Long
+        {
+            bool inside = true;
+            for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                if (p.pos(n) < region.lo(n) || p.pos(n) > region.hi(n)) inside = false;
+            }
+            return inside ? 1 : 0;
+        });
+    ParallelDescriptor::ReduceLongSum(nexpected);
+
+    const Long ntotal = pc.TotalNumberOfParticles();
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        ColumnarParticleReader reader("plt00000/particle0");
+
+        AMREX_ALWAYS_ASSERT(reader.numParticles() == ntotal);
+        AMREX_ALWAYS_ASSERT(reader.numRealComps() == AMREX_SPACEDIM + NSR + NAR);
+        AMREX_ALWAYS_ASSERT(reader.numIntComps() == 2 + NSI + NAI);
+        AMREX_ALWAYS_ASSERT(reader.realComp("c") == AMREX_SPACEDIM + 2);
+
+        Long nread = 0;
+        for (int i = 0; i < reader.numChunks(); ++i) {
+            AMREX_ALWAYS_ASSERT(reader.chunk(i).count <= params.chunk_size);
+            nread += reader.chunk(i).count;
+        }
+        AMREX_ALWAYS_ASSERT(nread == ntotal);
+
+        // only read the position columns of the chunks that overlap the region
+        const Vector<int> chunks = reader.selectChunks(region);
+        AMREX_ALWAYS_ASSERT(chunks.size() < reader.numChunks());
+
+        Long nfound = 0;
+        for (int ichunk : chunks)
+        {
+            Vector<Vector<ParticleReal> > pos(AMREX_SPACEDIM);
+            for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                pos[n] = reader.readRealComp(ichunk, n);
+            }
+            const Vector<int> j = reader.readIntComp(ichunk, reader.intComp("j"));
+            for (int k = 0; k < reader.chunk(ichunk).count; ++k)
+            {
+                AMREX_ALWAYS_ASSERT(j[k] == 5);
+                bool inside = true;
+                for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                    if (pos[n][k] < region.lo(n) || pos[n][k] > region.hi(n)) inside = false;
+                }
+                if (inside) ++nfound;
+            }
+        }
+        AMREX_ALWAYS_ASSERT(nfound == nexpected);
+
+        // value range selection
+        AMREX_ALWAYS_ASSERT(reader.selectChunksByReal(reader.realComp("b"), 1.5, 2.5).size()
+                            == reader.numChunks());
+        AMREX_ALWAYS_ASSERT(reader.selectChunksByInt(reader.intComp("i"), 4, 10).empty());
+
+        amrex::Print() << "pass \n";
+    }
+}
@@ -0,0 +1,300 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleSIMD_K.H>
+
+using namespace amrex;
+
+// SoA components 0 to AMREX_SPACEDIM-1 hold a copy of the positions, and the last
+// one receives the interpolated values.
+using PC = ParticleContainer<1, 0, AMREX_SPACEDIM+1, 0>;
+static constexpr int out_comp = AMREX_SPACEDIM;
+
+struct TestParams
+{
+    int size;
+    int max_grid_size;
+    int nppc;
+    int nrepeat;
+};
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("nppc", params.nppc);
+    params.nrepeat = 1;
+    pp.query("nrepeat", params.nrepeat);
+}
+
+void copyPositionsToSoA (PC& pc)
+{
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto& aos = pti.GetArrayOfStructs();
+        auto& soa = pti.GetStructOfArrays();
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            ParticleReal* x = soa.GetRealData(d).dataPtr();
+            for (Long i = 0, np = aos.numParticles(); i < np; ++i) {
+                x[i] = aos[i].pos(d);
+            }
+        }
+    }
+}
+
+GpuArray<ParticleReal const*,AMREX_SPACEDIM> soaPositions (PC::ParIterType& pti)
+{
+    auto& soa = pti.GetStructOfArrays();
+    return {AMREX_D_DECL(soa.GetRealData(0).dataPtr(),
+                         soa.GetRealData(1).dataPtr(),
+                         soa.GetRealData(2).dataPtr())};
+}
+
+// cell and node weights of the TSC kernel in direction d
+void tscWeights (ParticleReal x, Real plo, Real dxi, int& i, Real (&w)[3])
+{
+    Real l = (x - plo) * dxi;
+    i = static_cast<int>(std::floor(l));
+    Real f = l - i - Real(0.5);
+    w[0] = Real(0.5)*(Real(0.5)-f)*(Real(0.5)-f);
+    w[1] = Real(0.75) - f*f;
+    w[2] = Real(0.5)*(Real(0.5)+f)*(Real(0.5)+f);
+}
+
+// the scalar TSC kernels, one particle at a time
+void depositScalar (PC& pc, MultiFab& rho)
+{
+    BL_PROFILE("depositScalar");
+    const auto plo = pc.Geom(0).ProbLoArray();
+    const auto dxi = pc.Geom(0).InvCellSizeArray();
+    rho.setVal(0.0);
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto pstruct = pti.GetArrayOfStructs()().dataPtr();
+        const Long np = pti.numParticles();
+        auto const& arr = rho.array(pti);
+        for (Long ip = 0; ip < np; ++ip) {
+            const auto& p = pstruct[ip];
+            int iv[AMREX_SPACEDIM];
+            Real w[AMREX_SPACEDIM][3];
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                tscWeights(p.pos(d), plo[d], dxi[d], iv[d], w[d]);
+            }
+            for (int kk = 0; kk < AMREX_D_PICK(1,1,3); ++kk) {
+            for (int jj = 0; jj < AMREX_D_PICK(1,3,3); ++jj) {
+            for (int ii = 0; ii < 3; ++ii) {
+                arr(IntVect(AMREX_D_DECL(iv[0]+ii-1, iv[1]+jj-1, iv[2]+kk-1)))
+                    += p.rdata(0) * AMREX_D_TERM(w[0][ii], *w[1][jj], *w[2][kk]);
+            }}}
+        }
+    }
+}
+
+void interpolateScalar (PC& pc, const MultiFab& acc)
+{
+    BL_PROFILE("interpolateScalar");
+    const auto plo = pc.Geom(0).ProbLoArray();
+    const auto dxi = pc.Geom(0).InvCellSizeArray();
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto pstruct = pti.GetArrayOfStructs()().dataPtr();
+        auto out = pti.GetStructOfArrays().GetRealData(out_comp).dataPtr();
+        const Long np = pti.numParticles();
+        auto const& a = acc.const_array(pti);
+        for (Long ip = 0; ip < np; ++ip) {
+            const auto& p = pstruct[ip];
+            int iv[AMREX_SPACEDIM];
+            Real w[AMREX_SPACEDIM][3];
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                tscWeights(p.pos(d), plo[d], dxi[d], iv[d], w[d]);
+            }
+            Real r = 0.0;
+            for (int kk = 0; kk < AMREX_D_PICK(1,1,3); ++kk) {
+            for (int jj = 0; jj < AMREX_D_PICK(1,3,3); ++jj) {
+            for (int ii = 0; ii < 3; ++ii) {
+                r += AMREX_D_TERM(w[0][ii], *w[1][jj], *w[2][kk])
+                    * a(IntVect(AMREX_D_DECL(iv[0]+ii-1, iv[1]+jj-1, iv[2]+kk-1)));
+            }}}
+            out[ip] = r;
+        }
+    }
+}
+
+void depositSIMD (PC& pc, MultiFab& rho, bool soa)
+{
+    BL_PROFILE("depositSIMD");
+    const auto plo = pc.Geom(0).ProbLoArray();
+    const auto dxi = pc.Geom(0).InvCellSizeArray();
+    rho.setVal(0.0);
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto pstruct = pti.GetArrayOfStructs()().dataPtr();
+        const Long np = pti.numParticles();
+        const auto weight = [=] (Long i) { return pstruct[i].rdata(0); };
+        if (soa) {
+            amrex_deposit_tsc_simd(soaPositions(pti), np, weight, rho.array(pti), 0, plo, dxi);
+        } else {
+            amrex_deposit_tsc_simd(pstruct, np, weight, rho.array(pti), 0, plo, dxi);
+        }
+    }
+}
+
+void interpolateSIMD (PC& pc, const MultiFab& acc, bool soa)
+{
+    BL_PROFILE("interpolateSIMD");
+    const auto plo = pc.Geom(0).ProbLoArray();
+    const auto dxi = pc.Geom(0).InvCellSizeArray();
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto pstruct = pti.GetArrayOfStructs()().dataPtr();
+        ParticleReal* out = pti.GetStructOfArrays().GetRealData(out_comp).dataPtr();
+        if (soa) {
+            amrex_interpolate_tsc_simd(soaPositions(pti), pti.numParticles(),
+                                       acc.const_array(pti), 0, 1, &out, plo, dxi);
+        } else {
+            amrex_interpolate_tsc_simd(pstruct, pti.numParticles(),
+                                       acc.const_array(pti), 0, 1, &out, plo, dxi);
+        }
+    }
+}
+
+Real maxRelDiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab diff(a.boxArray(), a.DistributionMap(), 1, a.nGrow());
+    MultiFab::Copy(diff, a, 0, 0, 1, a.nGrow());
+    MultiFab::Subtract(diff, b, 0, 0, 1, a.nGrow());
+    return diff.norm0(0, a.nGrow()) / a.norm0(0, a.nGrow());
+}
+
+Vector<ParticleReal> gatherSoA (PC& pc)
+{
+    Vector<ParticleReal> r;
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+        const auto& v = pti.GetStructOfArrays().GetRealData(out_comp);
+        r.insert(r.end(), v.begin(), v.end());
+    }
+    return r;
+}
+
+template <class F>
+Real timeIt (int nrepeat, F&& f)
+{
+    ParallelDescriptor::Barrier();
+    Real t0 = amrex::second();
+    for (int n = 0; n < nrepeat; ++n) f();
+    Real t = (amrex::second() - t0) / nrepeat;
+    ParallelDescriptor::ReduceRealMax(t);
+    return t;
+}
+
+void compareAndTime (PC& pc, const MultiFab& acc, int nrepeat, const std::string& label)
+{
+    MultiFab rho_scalar(acc.boxArray(), acc.DistributionMap(), 1, 1);
+    MultiFab rho_simd(acc.boxArray(), acc.DistributionMap(), 1, 1);
+
+    depositScalar(pc, rho_scalar);
+    interpolateScalar(pc, acc);
+    auto ref = gatherSoA(pc);
+
+    for (bool soa : {true, false})
+    {
+        depositSIMD(pc, rho_simd, soa);
+        const Real dep_err = maxRelDiff(rho_scalar, rho_simd);
+
+        interpolateSIMD(pc, acc, soa);
+        auto res = gatherSoA(pc);
+        Real interp_err = 0.0;
+        for (int i = 0, N = ref.size(); i < N; ++i) {
+            interp_err = std::max(interp_err, Real(std::abs(ref[i]-res[i])));
+        }
+        ParallelDescriptor::ReduceRealMax(interp_err);
+
+        amrex::Print() << label << (soa ? " SoA" : " AoS") << ": max rel. deposit diff = "
+                       << dep_err << ", max interpolation diff = " << interp_err << "\n";
+        AMREX_ALWAYS_ASSERT(dep_err < 1.e-12);
+        AMREX_ALWAYS_ASSERT(interp_err < 1.e-12);
+    }
+
+    const Real tds = timeIt(nrepeat, [&] () { depositScalar(pc, rho_scalar); });
+    const Real tis = timeIt(nrepeat, [&] () { interpolateScalar(pc, acc); });
+    amrex::Print() << label << ": deposit     scalar " << tds << " s\n"
+                   << label << ": interpolate scalar " << tis << " s\n";
+    for (bool soa : {true, false})
+    {
+        const Real tdv = timeIt(nrepeat, [&] () { depositSIMD(pc, rho_simd, soa); });
+        const Real tiv = timeIt(nrepeat, [&] () { interpolateSIMD(pc, acc, soa); });
+        const char* mode = soa ? " SoA" : " AoS";
+        amrex::Print() << label << mode << ": deposit     batched " << tdv
+                       << " s, speedup " << tds/tdv << "\n"
+                       << label << mode << ": interpolate batched " << tiv
+                       << " s, speedup " << tis/tiv << "\n";
+    }
+}
+
+void testDepositSIMD ()
+{
+    TestParams params;
+    get_test_params(params, "deposit");
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+
+    const Box domain(IntVect(0), IntVect(params.size - 1));
+    int is_per[] = {AMREX_D_DECL(1, 1, 1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    PC pc(geom, dm, ba);
+
+    const Long num_particles = Long(params.nppc) * domain.numPts();
+    PC::ParticleInitData pdata = {{1.0}, {}, {AMREX_D_DECL(0.0, 0.0, 0.0), 0.0}, {}};
+    pc.InitRandom(num_particles, 451, pdata, false);
+    // give the particles different weights
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+        auto& aos = pti.GetArrayOfStructs();
+        for (auto& p : aos) p.rdata(0) = 1.0 + 0.001*(p.id() % 1000);
+    }
+
+    MultiFab acc(ba, dm, 1, 1);
+    for (MFIter mfi(acc); mfi.isValid(); ++mfi) {
+        auto const& a = acc.array(mfi);
+        const Box& bx = mfi.validbox();
+        const auto dx = geom.CellSizeArray();
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            amrex::ignore_unused(j,k);
+            Real v = 0.0;
+            AMREX_D_TERM(v += std::sin(6.28*(i+0.5)*dx[0]);,
+                         v += std::cos(6.28*(j+0.5)*dx[1]);,
+                         v *= (k+0.5)*dx[2];)
+            a(i,j,k) = v;
+        });
+    }
+    acc.FillBoundary(geom.periodicity());
+
+    amrex::Print() << num_particles << " particles, " << ba.size() << " grids\n";
+
+    copyPositionsToSoA(pc);
+    compareAndTime(pc, acc, params.nrepeat, "unsorted");
+
+    pc.SortParticlesByCell();
+    copyPositionsToSoA(pc);
+    compareAndTime(pc, acc, params.nrepeat, "sorted");
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    testDepositSIMD();
+    amrex::Print() << "pass \n";
+    amrex::Finalize();
+}
@@ -0,0 +1,141 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+
+using namespace amrex;
+
+static constexpr int NSR = 1;
+static constexpr int NSI = 0;
+static constexpr int NAR = 0;
+static constexpr int NAI = 0;
+
+using TestParticleContainer = ParticleContainer<NSR, NSI, NAR, NAI>;
+
+struct TestParams
+{
+    IntVect size;
+    int max_grid_size;
+    int num_particles;
+};
+
+void testLoadBalance ();
+
+// Mean over max of the number of particles per process
+Real particleEfficiency (const TestParticleContainer& pc)
+{
+    Long np = pc.NumberOfParticlesAtLevel(0, true, true);
+    Long np_max = np;
+    ParallelDescriptor::ReduceLongSum(np);
+    ParallelDescriptor::ReduceLongMax(np_max);
+    return static_cast<Real>(np) / (ParallelDescriptor::NProcs()*static_cast<Real>(np_max));
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    amrex::Print() << "Running particle load balance test \n";
+    testLoadBalance();
+
+    amrex::Finalize();
+}
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("num_particles", params.num_particles);
+}
+
+void testLoadBalance ()
+{
+    BL_PROFILE("testLoadBalance");
+    TestParams params;
+    get_test_params(params, "lb");
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+
+    IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+    IntVect domain_hi(AMREX_D_DECL(params.size[0]-1,params.size[1]-1,params.size[2]-1));
+    const Box domain(domain_lo, domain_hi);
+
+    int coord = 0;
+    int is_per[AMREX_SPACEDIM];
+    for (int i = 0; i < AMREX_SPACEDIM; i++)
+        is_per[i] = 1;
+    Geometry geom(domain, &real_box, coord, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+
+    // put all the particles into one corner of the domain, and all the boxes
+    // of that corner on process 0.  InitRandom ignores a box that touches the
+    // domain boundary.
+    RealBox corner;
+    IntVect corner_lo, corner_hi;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        corner.setLo(n, 0.1);
+        corner.setHi(n, 0.3);
+        corner_lo[n] = static_cast<int>(0.1*params.size[n]);
+        corner_hi[n] = static_cast<int>(0.3*params.size[n]);
+    }
+    const Box corner_box(corner_lo, corner_hi);
+    const int nprocs = ParallelDescriptor::NProcs();
+    Vector<int> pmap(ba.size());
+    for (int i = 0; i < ba.size(); ++i) {
+        pmap[i] = ba[i].intersects(corner_box) ? 0 : i % nprocs;
+    }
+    DistributionMapping dm(pmap);
+
+    TestParticleContainer pc(geom, dm, ba);
+    pc.SetVerbose(1);
+    TestParticleContainer::ParticleInitData pdata = {{1.0}, {}, {}, {}};
+    pc.InitRandom(params.num_particles, 451, pdata, false, corner);
+
+    const Long np_old = pc.TotalNumberOfParticles();
+
+    // with an impossible threshold nothing should change
+    bool changed = pc.LoadBalance({}, ParticleLoadBalanceInfo().setEfficiencyRatioThreshold(1.e10));
+    AMREX_ALWAYS_ASSERT(!changed);
+    AMREX_ALWAYS_ASSERT(DistributionMapping::SameRefs(pc.ParticleDistributionMap(0), dm));
+
+    // with the particle counts alone, the particles have to be spread over the processes
+    const Real eff_before = particleEfficiency(pc);
+    changed = pc.LoadBalance({}, ParticleLoadBalanceInfo().setEfficiencyRatioThreshold(1.0));
+    const Real eff_after = particleEfficiency(pc);
+    amrex::Print() << "particle efficiency " << eff_before << " -> " << eff_after << "\n";
+    AMREX_ALWAYS_ASSERT(eff_after >= eff_before);
+    if (nprocs > 1) {
+        AMREX_ALWAYS_ASSERT(changed && eff_after > eff_before);
+    }
+    AMREX_ALWAYS_ASSERT(pc.OK());
+    AMREX_ALWAYS_ASSERT(pc.TotalNumberOfParticles() == np_old);
+
+    // particle counts combined with a uniform mesh cost
+    for (auto strategy : {DistributionMapping::KNAPSACK, DistributionMapping::SFC})
+    {
+        const DistributionMapping& dm_old = pc.ParticleDistributionMap(0);
+        LayoutData<Real> mcost(pc.ParticleBoxArray(0), dm_old);
+        for (int gid : mcost.IndexArray()) mcost[gid] = 1.0;
+
+        changed = pc.LoadBalance({&mcost}, ParticleLoadBalanceInfo().setStrategy(strategy)
+                                                                    .setEfficiencyRatioThreshold(1.0));
+        if (ParallelDescriptor::NProcs() == 1) {
+            AMREX_ALWAYS_ASSERT(!changed);
+        }
+
+        AMREX_ALWAYS_ASSERT(pc.OK());
+        AMREX_ALWAYS_ASSERT(pc.TotalNumberOfParticles() == np_old);
+        AMREX_ALWAYS_ASSERT(pc.ParticleDistributionMap(0).size() == ba.size());
+    }
+
+    amrex::Print() << "pass \n";
+}
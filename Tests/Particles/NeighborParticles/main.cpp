@@ -22,6 +22,8 @@ void testNeighborParticles();
 
 void testNeighborList();
 
+void testBatchedNeighbors();
+
 int main (int argc, char* argv[])
 {
     amrex::Initialize(argc,argv);
@@ -32,6 +34,9 @@ int main (int argc, char* argv[])
     amrex::PrintToFile("neighbor_test") << "Running neighbor list test \n";
     testNeighborList();
 
+    amrex::PrintToFile("neighbor_test") << "Running batched neighbors test \n";
+    testBatchedNeighbors();
+
     amrex::Finalize();
 }
 
@@ -184,3 +189,101 @@ void testNeighborList ()
 
     pc.checkNeighborList();
 }
+
+// number of neighbors and the sum of their positions, over all ranks
+std::pair<Long, Real> neighborSummary (MDParticleContainer& pc)
+{
+    const int lev = 0;
+    Long nn = 0;
+    Real sum = 0.0;
+    for (MFIter mfi = pc.MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        auto index = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+        auto& ptile = pc.GetParticles(lev)[index];
+        const auto& aos = ptile.GetArrayOfStructs();
+        for (int i = ptile.numRealParticles(); i < ptile.numTotalParticles(); ++i) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                sum += aos[i].pos(idim);
+            }
+            ++nn;
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(nn);
+    ParallelDescriptor::ReduceRealSum(sum);
+    return std::make_pair(nn, sum);
+}
+
+void testBatchedNeighbors ()
+{
+    BL_PROFILE("testBatchedNeighbors");
+    TestParams params;
+    get_test_params(params, "nbor_parts");
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, params.size[n]);
+    }
+
+    IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+    IntVect domain_hi(AMREX_D_DECL(params.size[0]-1,params.size[1]-1,params.size[2]-1));
+    const Box domain(domain_lo, domain_hi);
+
+    int coord = 0;
+    int is_per[BL_SPACEDIM];
+    for (int i = 0; i < BL_SPACEDIM; i++)
+        is_per[i] = params.is_periodic;
+    Geometry geom(domain, &real_box, coord, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    // two "species", each filled both one at a time and batched
+    const int ncells = 1;
+    MDParticleContainer pc1(geom, dm, ba, ncells), pc1_ref(geom, dm, ba, ncells);
+    MDParticleContainer pc2(geom, dm, ba, ncells), pc2_ref(geom, dm, ba, ncells);
+
+    int npc = params.num_ppc;
+    pc1.InitParticles(IntVect(AMREX_D_DECL(npc, npc, npc)), 1.0, 0.0);
+    pc1_ref.InitParticles(IntVect(AMREX_D_DECL(npc, npc, npc)), 1.0, 0.0);
+    pc2.InitParticles(IntVect(AMREX_D_DECL(npc+1, npc+1, npc+1)), 1.0, 0.0);
+    pc2_ref.InitParticles(IntVect(AMREX_D_DECL(npc+1, npc+1, npc+1)), 1.0, 0.0);
+
+    pc1_ref.fillNeighbors();
+    pc2_ref.fillNeighbors();
+    fillNeighborsBatched(pc1, pc2);
+
+    AMREX_ALWAYS_ASSERT(neighborSummary(pc1) == neighborSummary(pc1_ref));
+    AMREX_ALWAYS_ASSERT(neighborSummary(pc2) == neighborSummary(pc2_ref));
+
+    pc1.moveParticles(static_cast<amrex::ParticleReal> (0.1));
+    pc1_ref.moveParticles(static_cast<amrex::ParticleReal> (0.1));
+    pc2.moveParticles(static_cast<amrex::ParticleReal> (0.2));
+    pc2_ref.moveParticles(static_cast<amrex::ParticleReal> (0.2));
+
+    pc1_ref.updateNeighbors();
+    pc2_ref.updateNeighbors();
+    updateNeighborsBatched(pc1, pc2);
+
+    AMREX_ALWAYS_ASSERT(neighborSummary(pc1) == neighborSummary(pc1_ref));
+    AMREX_ALWAYS_ASSERT(neighborSummary(pc2) == neighborSummary(pc2_ref));
+
+    // one container at a time after the batched calls, which reuses the
+    // receive counts of the batched exchange
+    pc1.moveParticles(static_cast<amrex::ParticleReal> (0.1));
+    pc1_ref.moveParticles(static_cast<amrex::ParticleReal> (0.1));
+    pc2.moveParticles(static_cast<amrex::ParticleReal> (0.2));
+    pc2_ref.moveParticles(static_cast<amrex::ParticleReal> (0.2));
+
+    pc1_ref.updateNeighbors();
+    pc2_ref.updateNeighbors();
+    pc1.updateNeighbors();
+    pc2.updateNeighbors();
+
+    AMREX_ALWAYS_ASSERT(neighborSummary(pc1) == neighborSummary(pc1_ref));
+    AMREX_ALWAYS_ASSERT(neighborSummary(pc2) == neighborSummary(pc2_ref));
+
+    amrex::PrintToFile("neighbor_test") << "Batched neighbors match \n";
+}
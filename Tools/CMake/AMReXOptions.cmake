@@ -277,6 +277,11 @@ cmake_dependent_option(AMReX_PETSC "Enable PETSc interfaces" OFF
    "AMReX_LINEAR_SOLVERS" OFF )
 print_option(AMReX_PETSC)
 
+# SWFFT (requires FFTW)
+cmake_dependent_option(AMReX_SWFFT "Enable the SWFFT based Poisson solvers" OFF
+   "AMReX_LINEAR_SOLVERS;AMReX_MPI" OFF )
+print_option(AMReX_SWFFT)
+
 # HDF5
 option(AMReX_HDF5 "Enable HDF5-based I/O" OFF)
 print_option(AMReX_HDF5)
@@ -74,6 +74,14 @@ if (AMReX_PETSC)
     target_link_libraries( amrex PUBLIC PETSC )
 endif ()
 
+#
+# FFTW for SWFFT
+#
+if (AMReX_SWFFT)
+    find_package(FFTW REQUIRED)
+    target_link_libraries( amrex PUBLIC FFTW )
+endif ()
+
 #
 # SUNDIALS
 #
@@ -0,0 +1,53 @@
+#[=======================================================================[:
+FindFFTW
+-------
+
+Finds the double precision FFTW3 library.
+
+Imported Targets
+^^^^^^^^^^^^^^^^
+
+This module provides the following imported target, if found:
+
+``FFTW``
+  The FFTW library
+
+Result Variables
+^^^^^^^^^^^^^^^^
+
+This will define the following variables:
+
+``FFTW_FOUND``
+  True if the FFTW library has been found.
+``FFTW_INCLUDE_DIRS``
+  Include directories needed to use FFTW.
+``FFTW_LIBRARIES``
+  Libraries needed to link to FFTW.
+#]=======================================================================]
+
+# Find include directories
+find_path(FFTW_INCLUDE_DIRS NAMES fftw3.h)
+
+# Find libraries
+find_library(FFTW_LIBRARIES NAMES fftw3)
+
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(FFTW
+   REQUIRED_VARS
+   FFTW_LIBRARIES
+   FFTW_INCLUDE_DIRS
+   )
+
+mark_as_advanced(FFTW_LIBRARIES FFTW_INCLUDE_DIRS)
+
+# Create imported target
+if (FFTW_FOUND AND NOT TARGET FFTW)
+   add_library(FFTW UNKNOWN IMPORTED GLOBAL)
+   set_target_properties(FFTW
+      PROPERTIES
+      IMPORTED_LOCATION "${FFTW_LIBRARIES}"
+      INTERFACE_INCLUDE_DIRECTORIES "${FFTW_INCLUDE_DIRS}"
+      )
+endif ()